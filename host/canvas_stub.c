@@ -0,0 +1,226 @@
+#include <gui/canvas.h>
+
+#include <stdlib.h>
+#include <string.h>
+
+struct Canvas {
+    uint8_t fb[CANVAS_STUB_HEIGHT][CANVAS_STUB_WIDTH];
+    Color color;
+    Font font;
+    CanvasStubStats stats;
+};
+
+Canvas* canvas_stub_alloc(void) {
+    Canvas* canvas = malloc(sizeof(Canvas));
+    canvas_reset(canvas);
+    return canvas;
+}
+
+void canvas_stub_free(Canvas* canvas) {
+    free(canvas);
+}
+
+const CanvasStubStats* canvas_stub_get_stats(const Canvas* canvas) {
+    return &canvas->stats;
+}
+
+const uint8_t* canvas_stub_get_framebuffer(const Canvas* canvas) {
+    return &canvas->fb[0][0];
+}
+
+static void canvas_stub_pixel(Canvas* canvas, int32_t x, int32_t y) {
+    if(x < 0 || y < 0 || x >= CANVAS_STUB_WIDTH || y >= CANVAS_STUB_HEIGHT) {
+        return;
+    }
+    uint8_t* px = &canvas->fb[y][x];
+    switch(canvas->color) {
+    case ColorWhite:
+        *px = 0;
+        break;
+    case ColorBlack:
+        *px = 1;
+        break;
+    case ColorXOR:
+        *px ^= 1;
+        break;
+    }
+    canvas->stats.pixels++;
+}
+
+void canvas_reset(Canvas* canvas) {
+    memset(canvas, 0, sizeof(Canvas));
+    canvas->color = ColorBlack;
+    canvas->font = FontSecondary;
+}
+
+void canvas_set_color(Canvas* canvas, Color color) {
+    canvas->color = color;
+    canvas->stats.state_changes++;
+}
+
+void canvas_set_font(Canvas* canvas, Font font) {
+    canvas->font = font;
+    canvas->stats.state_changes++;
+}
+
+void canvas_draw_str_aligned(
+    Canvas* canvas,
+    int32_t x,
+    int32_t y,
+    Align horizontal,
+    Align vertical,
+    const char* str) {
+    (void)x;
+    (void)y;
+    (void)horizontal;
+    (void)vertical;
+    canvas->stats.draw_calls++;
+    canvas->stats.text_chars += strlen(str);
+}
+
+void canvas_draw_dot(Canvas* canvas, int32_t x, int32_t y) {
+    canvas->stats.draw_calls++;
+    canvas_stub_pixel(canvas, x, y);
+}
+
+static void canvas_stub_box(Canvas* canvas, int32_t x, int32_t y, size_t width, size_t height) {
+    for(size_t j = 0; j < height; j++) {
+        for(size_t i = 0; i < width; i++) {
+            canvas_stub_pixel(canvas, x + (int32_t)i, y + (int32_t)j);
+        }
+    }
+}
+
+void canvas_draw_box(Canvas* canvas, int32_t x, int32_t y, size_t width, size_t height) {
+    canvas->stats.draw_calls++;
+    canvas_stub_box(canvas, x, y, width, height);
+}
+
+void canvas_draw_frame(Canvas* canvas, int32_t x, int32_t y, size_t width, size_t height) {
+    canvas->stats.draw_calls++;
+    if(!width || !height) {
+        return;
+    }
+    canvas_stub_box(canvas, x, y, width, 1);
+    canvas_stub_box(canvas, x, y + (int32_t)height - 1, width, 1);
+    if(height > 2) {
+        canvas_stub_box(canvas, x, y + 1, 1, height - 2);
+        canvas_stub_box(canvas, x + (int32_t)width - 1, y + 1, 1, height - 2);
+    }
+}
+
+// Same midpoint quarter circles as u8g2_DrawRFrame, so rounded corners match the device
+static void canvas_stub_circle_section(
+    Canvas* canvas,
+    int32_t x,
+    int32_t y,
+    int32_t x0,
+    int32_t y0,
+    uint8_t quarters) {
+    if(quarters & 1) { // upper right
+        canvas_stub_pixel(canvas, x0 + x, y0 - y);
+        canvas_stub_pixel(canvas, x0 + y, y0 - x);
+    }
+    if(quarters & 2) { // upper left
+        canvas_stub_pixel(canvas, x0 - x, y0 - y);
+        canvas_stub_pixel(canvas, x0 - y, y0 - x);
+    }
+    if(quarters & 4) { // lower right
+        canvas_stub_pixel(canvas, x0 + x, y0 + y);
+        canvas_stub_pixel(canvas, x0 + y, y0 + x);
+    }
+    if(quarters & 8) { // lower left
+        canvas_stub_pixel(canvas, x0 - x, y0 + y);
+        canvas_stub_pixel(canvas, x0 - y, y0 + x);
+    }
+}
+
+static void
+    canvas_stub_circle(Canvas* canvas, int32_t x0, int32_t y0, int32_t rad, uint8_t quarters) {
+    int32_t f = 1 - rad;
+    int32_t ddF_x = 1;
+    int32_t ddF_y = -2 * rad;
+    int32_t x = 0;
+    int32_t y = rad;
+
+    canvas_stub_circle_section(canvas, x, y, x0, y0, quarters);
+    while(x < y) {
+        if(f >= 0) {
+            y--;
+            ddF_y += 2;
+            f += ddF_y;
+        }
+        x++;
+        ddF_x += 2;
+        f += ddF_x;
+        canvas_stub_circle_section(canvas, x, y, x0, y0, quarters);
+    }
+}
+
+void canvas_draw_rframe(
+    Canvas* canvas,
+    int32_t x,
+    int32_t y,
+    size_t width,
+    size_t height,
+    size_t radius) {
+    canvas->stats.draw_calls++;
+
+    int32_t w = (int32_t)width;
+    int32_t h = (int32_t)height;
+    int32_t r = (int32_t)radius;
+    int32_t xl = x + r;
+    int32_t yu = y + r;
+    int32_t xr = x + w - r - 1;
+    int32_t yl = y + h - r - 1;
+
+    canvas_stub_circle(canvas, xl, yu, r, 2);
+    canvas_stub_circle(canvas, xr, yu, r, 1);
+    canvas_stub_circle(canvas, xl, yl, r, 8);
+    canvas_stub_circle(canvas, xr, yl, r, 4);
+
+    int32_t ww = w - 2 * r;
+    int32_t hh = h - 2 * r;
+    if(ww >= 3) {
+        canvas_stub_box(canvas, xl + 1, y, ww - 2, 1);
+        canvas_stub_box(canvas, xl + 1, y + h - 1, ww - 2, 1);
+    }
+    if(hh >= 3) {
+        canvas_stub_box(canvas, x, yu + 1, 1, hh - 2);
+        canvas_stub_box(canvas, x + w - 1, yu + 1, 1, hh - 2);
+    }
+}
+
+static void canvas_stub_xbm(
+    Canvas* canvas,
+    int32_t x,
+    int32_t y,
+    size_t width,
+    size_t height,
+    const uint8_t* bitmap) {
+    // XBM rows are padded to whole bytes, bits are LSB first, only set bits are drawn
+    size_t stride = (width + 7) / 8;
+    for(size_t j = 0; j < height; j++) {
+        for(size_t i = 0; i < width; i++) {
+            if(bitmap[j * stride + i / 8] & (1 << (i % 8))) {
+                canvas_stub_pixel(canvas, x + (int32_t)i, y + (int32_t)j);
+            }
+        }
+    }
+}
+
+void canvas_draw_xbm(
+    Canvas* canvas,
+    int32_t x,
+    int32_t y,
+    size_t width,
+    size_t height,
+    const uint8_t* bitmap) {
+    canvas->stats.draw_calls++;
+    canvas_stub_xbm(canvas, x, y, width, height, bitmap);
+}
+
+void canvas_draw_icon(Canvas* canvas, int32_t x, int32_t y, const Icon* icon) {
+    canvas->stats.draw_calls++;
+    canvas_stub_xbm(canvas, x, y, icon->width, icon->height, icon->data);
+}
@@ -0,0 +1,103 @@
+#!/usr/bin/env python3
+"""Compile images/*.png into XBM Icon definitions for the host build.
+
+On the device fbt does this from fap_icon_assets and generates snake20_icons.h;
+this script emits the same header and the matching data so the renderer builds
+unchanged against the stub canvas. Only 1-bit and 8-bit grayscale PNGs are read,
+dark pixels become set bits.
+
+    icons.py <out_dir> <png>...
+"""
+
+import os
+import struct
+import sys
+import zlib
+
+
+def read_png(path):
+    with open(path, "rb") as f:
+        data = f.read()
+    if data[:8] != b"\x89PNG\r\n\x1a\n":
+        raise ValueError(f"{path}: not a PNG")
+    pos = 8
+    idat = b""
+    while pos < len(data):
+        length, kind = struct.unpack(">I4s", data[pos : pos + 8])
+        body = data[pos + 8 : pos + 8 + length]
+        if kind == b"IHDR":
+            width, height, depth, color, _, _, interlace = struct.unpack(">IIBBBBB", body)
+        elif kind == b"IDAT":
+            idat += body
+        pos += 12 + length
+    if color != 0 or depth not in (1, 8) or interlace:
+        raise ValueError(f"{path}: only non-interlaced 1/8-bit grayscale is supported")
+
+    raw = zlib.decompress(idat)
+    stride = (width * depth + 7) // 8
+    bpp = max(1, depth // 8)
+    rows = []
+    prev = bytearray(stride)
+    pos = 0
+    for _ in range(height):
+        kind = raw[pos]
+        line = bytearray(raw[pos + 1 : pos + 1 + stride])
+        pos += 1 + stride
+        for i in range(stride):
+            a = line[i - bpp] if i >= bpp else 0
+            b = prev[i]
+            c = prev[i - bpp] if i >= bpp else 0
+            if kind == 1:
+                line[i] = (line[i] + a) & 0xFF
+            elif kind == 2:
+                line[i] = (line[i] + b) & 0xFF
+            elif kind == 3:
+                line[i] = (line[i] + (a + b) // 2) & 0xFF
+            elif kind == 4:
+                p = a + b - c
+                pa, pb, pc = abs(p - a), abs(p - b), abs(p - c)
+                pred = a if pa <= pb and pa <= pc else b if pb <= pc else c
+                line[i] = (line[i] + pred) & 0xFF
+        prev = line
+        if depth == 1:
+            rows.append([(line[x // 8] >> (7 - x % 8)) & 1 == 0 for x in range(width)])
+        else:
+            rows.append([line[x] < 128 for x in range(width)])
+    return width, height, rows
+
+
+def to_xbm(width, rows):
+    out = []
+    for row in rows:
+        for byte in range((width + 7) // 8):
+            value = 0
+            for bit in range(8):
+                x = byte * 8 + bit
+                if x < width and row[x]:
+                    value |= 1 << bit
+            out.append(value)
+    return out
+
+
+def main():
+    out_dir, pngs = sys.argv[1], sorted(sys.argv[2:])
+    header = ["#pragma once", "", "#include <gui/icon.h>", ""]
+    source = ['#include "snake20_icons.h"', ""]
+    for path in pngs:
+        name = os.path.splitext(os.path.basename(path))[0]
+        width, height, rows = read_png(path)
+        data = ", ".join(f"0x{b:02x}" for b in to_xbm(width, rows))
+        header.append(f"extern const Icon I_{name};")
+        source.append(f"static const uint8_t _I_{name}_data[] = {{{data}}};")
+        source.append(
+            f"const Icon I_{name} = {{.width = {width}, .height = {height}, "
+            f".data = _I_{name}_data}};"
+        )
+    with open(os.path.join(out_dir, "snake20_icons.h"), "w") as f:
+        f.write("\n".join(header) + "\n")
+    with open(os.path.join(out_dir, "snake20_icons.c"), "w") as f:
+        f.write("\n".join(source) + "\n")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,151 @@
+#!/usr/bin/env python3
+"""Compile levels/*.txt into the run-length encoded walls of snake_levels.c.
+
+A level is a 31x15 text map of the classic board, '#' for a wall and '.' for an
+open cell; the file name, without its number prefix, names the level. The big
+board gets the same map scaled to 63x31. For each board size the cells are
+encoded row by row as run lengths, alternating open and wall starting with an
+open run, a byte each; a run over 255 is split into 255, an empty run of the
+other kind and the rest.
+
+Every level is checked to leave the start of a new game open and all of its
+open cells reachable from each other, so no fruit can grow where the snake
+can't get.
+
+    levels.py <out.c> <txt>...
+"""
+
+import os
+import sys
+
+CLASSIC = (31, 15)
+BIG = (63, 31)
+# Cells of the snake in a new game, see snake_game_init_game
+START = [(x, 6) for x in range(2, 9)]
+MAX_BLOB = 300
+
+
+def read_level(path):
+    with open(path) as f:
+        rows = [line.rstrip("\n") for line in f if line.strip()]
+    width, height = CLASSIC
+    if len(rows) != height or any(len(row) != width for row in rows):
+        raise ValueError(f"{path}: the map has to be {width}x{height}")
+    if any(c not in ".#" for row in rows for c in row):
+        raise ValueError(f"{path}: only '.' and '#' are allowed")
+    return [[c == "#" for c in row] for row in rows]
+
+
+def scale(walls, size):
+    width, height = size
+    src_width, src_height = CLASSIC
+    return [
+        [walls[y * src_height // height][x * src_width // width] for x in range(width)]
+        for y in range(height)
+    ]
+
+
+def check(path, walls, size):
+    width, height = size
+    for x, y in START:
+        if walls[y][x]:
+            raise ValueError(f"{path}: the snake starts on a wall at {x},{y} of {width}x{height}")
+    open_cells = [(x, y) for y in range(height) for x in range(width) if not walls[y][x]]
+    seen = {open_cells[0]}
+    todo = [open_cells[0]]
+    while todo:
+        x, y = todo.pop()
+        for nx, ny in ((x + 1, y), (x - 1, y), (x, y + 1), (x, y - 1)):
+            if 0 <= nx < width and 0 <= ny < height and not walls[ny][nx]:
+                if (nx, ny) not in seen:
+                    seen.add((nx, ny))
+                    todo.append((nx, ny))
+    if len(seen) != len(open_cells):
+        raise ValueError(f"{path}: not every open cell can be reached on {width}x{height}")
+
+
+def encode(walls):
+    runs = []
+    kind = False
+    count = 0
+    for row in walls:
+        for cell in row:
+            if cell != kind:
+                runs.append(count)
+                kind = cell
+                count = 0
+            count += 1
+    runs.append(count)
+
+    blob = []
+    for run in runs:
+        while run > 255:
+            blob += [255, 0]
+            run -= 255
+        blob.append(run)
+    return bytes(blob)
+
+
+def c_array(name, comment, blob):
+    lines = [f"// {comment}, {len(blob)} bytes", f"static const uint8_t {name}[] = {{"]
+    for i in range(0, len(blob), 12):
+        lines.append("    " + " ".join(f"{b}," for b in blob[i : i + 12]))
+    lines.append("};")
+    return "\n".join(lines)
+
+
+def level_name(path):
+    base = os.path.splitext(os.path.basename(path))[0]
+    return base.split("_", 1)[-1].replace("_", " ").capitalize()
+
+
+def main(out_path, paths):
+    paths = sorted(paths)
+    levels = [(path, read_level(path)) for path in paths]
+
+    sections = {}
+    for size, macro in ((BIG, "SNAKE_BIG_BOARD"), (CLASSIC, None)):
+        arrays = []
+        for i, (path, walls) in enumerate(levels, 1):
+            board = scale(walls, size) if size != CLASSIC else walls
+            check(path, board, size)
+            blob = encode(board)
+            if len(blob) > MAX_BLOB:
+                raise ValueError(f"{path}: {len(blob)} bytes on {size[0]}x{size[1]}")
+            arrays.append(c_array(f"level_{i}", os.path.basename(path), blob))
+        sections[macro] = "\n\n".join(arrays)
+
+    entries = ['    {.name = "Plain", .rle = NULL, .size = 0},']
+    for i, (path, _) in enumerate(levels, 1):
+        entries.append(
+            f'    {{.name = "{level_name(path)}", .rle = level_{i}, .size = sizeof(level_{i})}},'
+        )
+
+    with open(out_path, "w") as f:
+        f.write("// Generated by host/levels.py from levels/*.txt, ")
+        f.write("edit those and run make -C host levels\n")
+        f.write("\n")
+        f.write('#include "snake_levels.h"\n')
+        f.write("\n")
+        f.write("#include <stddef.h>\n")
+        f.write("\n")
+        f.write("#ifdef SNAKE_BIG_BOARD\n")
+        f.write(sections["SNAKE_BIG_BOARD"] + "\n")
+        f.write("#else\n")
+        f.write(sections[None] + "\n")
+        f.write("#endif\n")
+        f.write("\n")
+        f.write(f"const uint8_t snake_level_count = {len(levels) + 1};\n")
+        f.write("\n")
+        f.write("const SnakeLevel snake_levels[] = {\n")
+        f.write("\n".join(entries) + "\n")
+        f.write("};\n")
+
+
+if __name__ == "__main__":
+    if len(sys.argv) < 3:
+        sys.exit(__doc__)
+    try:
+        main(sys.argv[1], sys.argv[2:])
+    except ValueError as e:
+        sys.exit(str(e))
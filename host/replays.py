@@ -0,0 +1,75 @@
+#!/usr/bin/env python3
+"""Check bot-recorded replays against their golden checksums.
+
+Every line of replays.golden names a board, the arguments of a
+`snake_replay -g` recording and the checksum of the final state it has to
+print. A game that wasn't cut short also has to replay to that checksum. Any
+change to the rules, the random generator, the bots or the save format shows
+up here; when it is meant to, -u writes the new checksums of the board the
+build is for.
+
+    replays.py [-u] <snake_replay> <golden> <board> <dir>
+"""
+
+import os
+import re
+import subprocess
+import sys
+
+RECORDED = re.compile(r"^recorded .*, state (\w+)( \(truncated\))?, checksum ([0-9a-f]{8})$")
+REPLAYED = re.compile(r"^replayed .*, checksum ([0-9a-f]{8})$")
+
+
+def run(tool, args, pattern):
+    out = subprocess.run([tool] + args, check=True, capture_output=True, text=True).stdout
+    for line in out.splitlines():
+        match = pattern.match(line)
+        if match:
+            return match
+    sys.exit(f"unexpected output of {' '.join([tool] + args)}:\n{out}")
+
+
+def main(argv):
+    update = argv[:1] == ["-u"]
+    if update:
+        argv = argv[1:]
+    if len(argv) != 4:
+        sys.exit(__doc__)
+    tool, golden, board, out_dir = argv
+
+    with open(golden) as f:
+        lines = f.read().splitlines()
+    failures = 0
+    checked = 0
+    for n, line in enumerate(lines):
+        fields = line.split("#")[0].split()
+        if not fields or fields[0] != board:
+            continue
+        args, expected = fields[1:-1], fields[-1]
+        path = os.path.join(out_dir, f"golden_{n + 1}.replay")
+        recorded = run(tool, ["-g"] + args + [path], RECORDED)
+        checksum = recorded.group(3)
+        checked += 1
+        if update:
+            head, _, tail = line.rpartition(expected)
+            lines[n] = head + checksum + tail
+        elif checksum != expected:
+            print(f"FAIL {golden}:{n + 1}: -g {' '.join(args)} recorded {checksum}, "
+                  f"expected {expected}")
+            failures += 1
+        if not recorded.group(2):
+            replayed = run(tool, [path], REPLAYED).group(1)
+            if replayed != checksum:
+                print(f"FAIL {golden}:{n + 1}: -g {' '.join(args)} replayed {replayed}, "
+                      f"recorded {checksum}")
+                failures += 1
+
+    if update:
+        with open(golden, "w") as f:
+            f.write("\n".join(lines) + "\n")
+    print(f"replays.py: {checked} {board} replays, {failures} failed")
+    return 1 if failures or not checked else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv[1:]))
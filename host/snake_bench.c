@@ -0,0 +1,476 @@
+// Headless micro-benchmarks of the game core and the renderer.
+//
+//   build/snake_bench [-n samples] [-f csv|json]
+//
+// Every operation is timed one call at a time for a range of snake lengths,
+// results go to stdout as CSV (default) or JSON with p50/p99 next to the mean.
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include <gui/canvas.h>
+
+#include "snake_arena.h"
+#include "snake_game.h"
+#include "snake_render.h"
+#include "snake_save.h"
+
+#define BENCH_WARMUP 16
+
+typedef enum {
+    BenchFormatCsv,
+    BenchFormatJson,
+} BenchFormat;
+
+typedef struct {
+    const char* op;
+    uint16_t len;
+    uint32_t samples;
+    uint64_t mean_ns;
+    uint64_t p50_ns;
+    uint64_t p99_ns;
+    uint64_t min_ns;
+    uint64_t max_ns;
+    uint32_t draw_calls;
+    uint32_t state_changes;
+    uint32_t pixels;
+    uint32_t bytes;
+} BenchResult;
+
+typedef struct {
+    BenchFormat format;
+    uint32_t samples;
+    uint64_t* timings;
+    bool first_row;
+} Bench;
+
+static const uint16_t bench_lengths[] = {
+    7, 16, 32, 64, 128, 256, 384, MAX_SNAKE_LEN - 2, MAX_SNAKE_LEN - 1};
+
+static uint32_t bench_get_ms(void* ctx) {
+    (void)ctx;
+    return 0;
+}
+
+static uint32_t bench_random(void* ctx) {
+    uint32_t* state = ctx;
+    // xorshift32, fixed seed keeps runs comparable
+    *state ^= *state << 13;
+    *state ^= *state >> 17;
+    *state ^= *state << 5;
+    return *state;
+}
+
+static void bench_feedback(void* ctx, SnakeFeedback feedback) {
+    (void)ctx;
+    (void)feedback;
+}
+
+static uint64_t bench_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// Cells of the board in boustrophedon order: row 0 left to right, row 1 right to left...
+static Point bench_path_point(uint16_t k) {
+    uint8_t row = k / SNAKE_BOARD_WIDTH;
+    uint8_t col = k % SNAKE_BOARD_WIDTH;
+    Point p = {.x = row % 2 ? SNAKE_BOARD_WIDTH - 1 - col : col, .y = row};
+    return p;
+}
+
+// Lays a snake of `len` cells along the path: tail at the path start, the head
+// looking at the next free path cell. With `eat` the fruit is on that cell.
+static bool bench_make_state(SnakeState* snake_state, uint16_t len, bool eat) {
+    memset(snake_state, 0, sizeof(SnakeState));
+    snake_state->head_point = bench_path_point(len - 1);
+    for(uint16_t i = 0; i + 1 < len; i++) {
+        Point from = bench_path_point(len - 1 - i);
+        snake_game_set_body_direction(
+            snake_state, i, snake_game_direction(from, bench_path_point(len - 2 - i)));
+    }
+    snake_state->len = len;
+    snake_state->head = 0;
+    snake_state->rng = 0x2545F491;
+    if(!snake_game_restore(snake_state)) {
+        return false;
+    }
+
+    uint16_t fruit = eat ? len : len + 1;
+    if(fruit >= MAX_SNAKE_LEN) {
+        return false;
+    }
+    snake_state->fruit = bench_path_point(fruit);
+
+    Point head = bench_path_point(len - 1);
+    Direction dir = len < MAX_SNAKE_LEN ? snake_game_direction(head, bench_path_point(len)) :
+                                          DirectionRight;
+    snake_state->currentMovement = dir;
+    snake_state->nextMovement = dir;
+    snake_state->state = GameStateLife;
+    return true;
+}
+
+static int bench_compare_u64(const void* a, const void* b) {
+    uint64_t x = *(const uint64_t*)a;
+    uint64_t y = *(const uint64_t*)b;
+    return (x > y) - (x < y);
+}
+
+static void bench_summarize(Bench* bench, BenchResult* result) {
+    uint32_t n = bench->samples;
+    uint64_t* t = bench->timings;
+    qsort(t, n, sizeof(uint64_t), bench_compare_u64);
+
+    uint64_t sum = 0;
+    for(uint32_t i = 0; i < n; i++) {
+        sum += t[i];
+    }
+    result->samples = n;
+    result->mean_ns = sum / n;
+    result->p50_ns = t[(n - 1) * 50 / 100];
+    result->p99_ns = t[(n - 1) * 99 / 100];
+    result->min_ns = t[0];
+    result->max_ns = t[n - 1];
+}
+
+static void bench_print(Bench* bench, const BenchResult* r) {
+    if(bench->format == BenchFormatCsv) {
+        printf(
+            "%s,%u,%u,%llu,%llu,%llu,%llu,%llu,%u,%u,%u,%u\n",
+            r->op,
+            r->len,
+            r->samples,
+            (unsigned long long)r->mean_ns,
+            (unsigned long long)r->p50_ns,
+            (unsigned long long)r->p99_ns,
+            (unsigned long long)r->min_ns,
+            (unsigned long long)r->max_ns,
+            r->draw_calls,
+            r->state_changes,
+            r->pixels,
+            r->bytes);
+    } else {
+        printf(
+            "%s\n    {\"op\": \"%s\", \"len\": %u, \"samples\": %u, \"mean_ns\": %llu, "
+            "\"p50_ns\": %llu, \"p99_ns\": %llu, \"min_ns\": %llu, \"max_ns\": %llu, "
+            "\"draw_calls\": %u, \"state_changes\": %u, \"pixels\": %u, \"bytes\": %u}",
+            bench->first_row ? "" : ",",
+            r->op,
+            r->len,
+            r->samples,
+            (unsigned long long)r->mean_ns,
+            (unsigned long long)r->p50_ns,
+            (unsigned long long)r->p99_ns,
+            (unsigned long long)r->min_ns,
+            (unsigned long long)r->max_ns,
+            r->draw_calls,
+            r->state_changes,
+            r->pixels,
+            r->bytes);
+    }
+    bench->first_row = false;
+}
+
+static void bench_step(Bench* bench, SnakePlatform* platform, uint16_t len, bool eat) {
+    static SnakeState template;
+    static SnakeState work;
+    if(!bench_make_state(&template, len, eat)) {
+        return;
+    }
+
+    for(uint32_t i = 0; i < BENCH_WARMUP + bench->samples; i++) {
+        memcpy(&work, &template, sizeof(SnakeState));
+        uint64_t start = bench_now_ns();
+        snake_game_process_game_step(&work, platform);
+        uint64_t end = bench_now_ns();
+        if(i >= BENCH_WARMUP) {
+            bench->timings[i - BENCH_WARMUP] = end - start;
+        }
+    }
+
+    BenchResult result = {.op = eat ? "step_eat" : "step", .len = len};
+    bench_summarize(bench, &result);
+    bench_print(bench, &result);
+}
+
+static void bench_spawn(Bench* bench, uint16_t len) {
+    static SnakeState snake_state;
+    if(!bench_make_state(&snake_state, len, true)) {
+        return;
+    }
+
+    volatile uint8_t sink = 0;
+    for(uint32_t i = 0; i < BENCH_WARMUP + bench->samples; i++) {
+        uint64_t start = bench_now_ns();
+        Point fruit = snake_game_get_new_fruit(&snake_state);
+        uint64_t end = bench_now_ns();
+        sink ^= fruit.x;
+        if(i >= BENCH_WARMUP) {
+            bench->timings[i - BENCH_WARMUP] = end - start;
+        }
+    }
+    (void)sink;
+
+    BenchResult result = {.op = "spawn", .len = len};
+    bench_summarize(bench, &result);
+    bench_print(bench, &result);
+}
+
+static void bench_render(Bench* bench, uint16_t len, GameState state) {
+    static SnakeState snake_state;
+    static SnakeFrame frame;
+    if(!bench_make_state(&snake_state, len, true)) {
+        return;
+    }
+    snake_state.state = state;
+    snake_playfield_draw(&frame.playfield, &snake_state);
+    frame.overlay.valid = false;
+    snake_frame_capture(&frame, &snake_state);
+
+    Canvas* canvas = canvas_stub_alloc();
+    for(uint32_t i = 0; i < BENCH_WARMUP + bench->samples; i++) {
+        canvas_reset(canvas);
+        uint64_t start = bench_now_ns();
+        snake_game_render(canvas, &frame);
+        uint64_t end = bench_now_ns();
+        if(i >= BENCH_WARMUP) {
+            bench->timings[i - BENCH_WARMUP] = end - start;
+        }
+    }
+
+    const CanvasStubStats* stats = canvas_stub_get_stats(canvas);
+    BenchResult result = {
+        .op = state == GameStatePause ? "render_pause" : "render",
+        .len = len,
+        .draw_calls = stats->draw_calls,
+        .state_changes = stats->state_changes,
+        .pixels = stats->pixels,
+    };
+    canvas_stub_free(canvas);
+
+    bench_summarize(bench, &result);
+    bench_print(bench, &result);
+}
+
+// The handoff between the game loop and the GUI thread, uncontended
+static void bench_frame_latch(Bench* bench, uint16_t len) {
+    static SnakeState snake_state;
+    static SnakeFrame frame;
+    static SnakeFrame copy;
+    static SnakeFrameLatch latch;
+    if(!bench_make_state(&snake_state, len, true)) {
+        return;
+    }
+    snake_playfield_draw(&frame.playfield, &snake_state);
+    snake_frame_capture(&frame, &snake_state);
+    snake_frame_latch_init(&latch, &frame);
+
+    for(uint32_t i = 0; i < BENCH_WARMUP + bench->samples; i++) {
+        uint64_t start = bench_now_ns();
+        snake_frame_publish(&latch, &frame);
+        uint64_t end = bench_now_ns();
+        if(i >= BENCH_WARMUP) {
+            bench->timings[i - BENCH_WARMUP] = end - start;
+        }
+    }
+    BenchResult publish = {.op = "frame_publish", .len = len, .bytes = sizeof(SnakeFrame)};
+    bench_summarize(bench, &publish);
+    bench_print(bench, &publish);
+
+    for(uint32_t i = 0; i < BENCH_WARMUP + bench->samples; i++) {
+        uint64_t start = bench_now_ns();
+        snake_frame_read(&latch, &copy);
+        uint64_t end = bench_now_ns();
+        if(i >= BENCH_WARMUP) {
+            bench->timings[i - BENCH_WARMUP] = end - start;
+        }
+    }
+    BenchResult read = {.op = "frame_read", .len = len, .bytes = sizeof(SnakeFrame)};
+    bench_summarize(bench, &read);
+    bench_print(bench, &read);
+}
+
+// Incremental playfield repaint after a step, the game loop's share of the rendering
+static void bench_playfield(Bench* bench, SnakePlatform* platform, uint16_t len, bool eat) {
+    static SnakeState template;
+    static SnakeState work;
+    static SnakePlayfield playfield;
+    if(!bench_make_state(&template, len, eat)) {
+        return;
+    }
+
+    for(uint32_t i = 0; i < BENCH_WARMUP + bench->samples; i++) {
+        memcpy(&work, &template, sizeof(SnakeState));
+        snake_game_process_game_step(&work, platform);
+        uint64_t start = bench_now_ns();
+        snake_playfield_update(&playfield, &work);
+        uint64_t end = bench_now_ns();
+        if(i >= BENCH_WARMUP) {
+            bench->timings[i - BENCH_WARMUP] = end - start;
+        }
+    }
+    BenchResult update = {.op = eat ? "playfield_update_eat" : "playfield_update", .len = len};
+    bench_summarize(bench, &update);
+    bench_print(bench, &update);
+
+    for(uint32_t i = 0; i < BENCH_WARMUP + bench->samples; i++) {
+        uint64_t start = bench_now_ns();
+        snake_playfield_draw(&playfield, &template);
+        uint64_t end = bench_now_ns();
+        if(i >= BENCH_WARMUP) {
+            bench->timings[i - BENCH_WARMUP] = end - start;
+        }
+    }
+    BenchResult draw = {.op = eat ? "playfield_draw_eat" : "playfield_draw", .len = len};
+    bench_summarize(bench, &draw);
+    bench_print(bench, &draw);
+}
+
+// Mirrors save_game()/load_game() in the app minus the SD card
+static void bench_save_load(Bench* bench, uint16_t len) {
+    static SnakeState snake_state;
+    static uint8_t buffer[SNAKE_SAVE_MAX_SIZE];
+    if(!bench_make_state(&snake_state, len, true)) {
+        return;
+    }
+
+    size_t size = 0;
+    for(uint32_t i = 0; i < BENCH_WARMUP + bench->samples; i++) {
+        uint64_t start = bench_now_ns();
+        size = snake_save_encode(&snake_state, buffer, sizeof(buffer));
+        uint64_t end = bench_now_ns();
+        if(i >= BENCH_WARMUP) {
+            bench->timings[i - BENCH_WARMUP] = end - start;
+        }
+    }
+    BenchResult save = {.op = "save", .len = len, .bytes = size};
+    bench_summarize(bench, &save);
+    bench_print(bench, &save);
+
+    for(uint32_t i = 0; i < BENCH_WARMUP + bench->samples; i++) {
+        uint64_t start = bench_now_ns();
+        bool ok = snake_save_decode(&snake_state, buffer, size);
+        uint64_t end = bench_now_ns();
+        if(!ok) {
+            fprintf(stderr, "load failed at len %u\n", len);
+            return;
+        }
+        if(i >= BENCH_WARMUP) {
+            bench->timings[i - BENCH_WARMUP] = end - start;
+        }
+    }
+    BenchResult load = {.op = "load", .len = len, .bytes = size};
+    bench_summarize(bench, &load);
+    bench_print(bench, &load);
+}
+
+// The arena's batched step of every snake and the playfield update after it. The player's
+// snake goes straight on, a game that ends is started over outside the timing.
+static void bench_arena(Bench* bench, SnakePlatform* platform) {
+    static SnakeArena arena;
+    static SnakePlayfield playfield;
+    uint64_t* update_timings = malloc(bench->samples * sizeof(uint64_t));
+    snake_arena_init(&arena, platform);
+    snake_playfield_draw_arena(&playfield, &arena);
+
+    for(uint32_t i = 0; i < BENCH_WARMUP + bench->samples; i++) {
+        if(arena.state == GameStateGameOver) {
+            snake_arena_init(&arena, platform);
+            snake_playfield_draw_arena(&playfield, &arena);
+        }
+        uint64_t start = bench_now_ns();
+        snake_arena_step(&arena, platform);
+        uint64_t stepped = bench_now_ns();
+        snake_playfield_update_arena(&playfield, &arena);
+        uint64_t end = bench_now_ns();
+        if(i >= BENCH_WARMUP) {
+            bench->timings[i - BENCH_WARMUP] = stepped - start;
+            update_timings[i - BENCH_WARMUP] = end - stepped;
+        }
+    }
+
+    BenchResult step = {.op = "arena_step", .len = SNAKE_ARENA_START_LEN};
+    bench_summarize(bench, &step);
+    bench_print(bench, &step);
+
+    memcpy(bench->timings, update_timings, bench->samples * sizeof(uint64_t));
+    BenchResult update = {.op = "arena_playfield", .len = SNAKE_ARENA_START_LEN};
+    bench_summarize(bench, &update);
+    bench_print(bench, &update);
+    free(update_timings);
+}
+
+static void bench_usage(const char* name) {
+    fprintf(stderr, "usage: %s [-n samples] [-f csv|json]\n", name);
+}
+
+int main(int argc, char** argv) {
+    Bench bench = {.format = BenchFormatCsv, .samples = 1000, .first_row = true};
+
+    for(int i = 1; i < argc; i++) {
+        if(!strcmp(argv[i], "-n") && i + 1 < argc) {
+            bench.samples = strtoul(argv[++i], NULL, 10);
+        } else if(!strcmp(argv[i], "-f") && i + 1 < argc) {
+            const char* format = argv[++i];
+            if(!strcmp(format, "csv")) {
+                bench.format = BenchFormatCsv;
+            } else if(!strcmp(format, "json")) {
+                bench.format = BenchFormatJson;
+            } else {
+                bench_usage(argv[0]);
+                return 1;
+            }
+        } else {
+            bench_usage(argv[0]);
+            return 1;
+        }
+    }
+    if(!bench.samples) {
+        bench_usage(argv[0]);
+        return 1;
+    }
+
+    bench.timings = malloc(bench.samples * sizeof(uint64_t));
+
+    uint32_t seed = 0x2545F491;
+    SnakePlatform platform = {
+        .get_ms = bench_get_ms,
+        .random = bench_random,
+        .feedback = bench_feedback,
+        .ctx = &seed,
+    };
+
+    if(bench.format == BenchFormatCsv) {
+        printf("op,len,samples,mean_ns,p50_ns,p99_ns,min_ns,max_ns,"
+               "draw_calls,state_changes,pixels,bytes\n");
+    } else {
+        printf("{\"results\": [");
+    }
+
+    for(size_t i = 0; i < sizeof(bench_lengths) / sizeof(bench_lengths[0]); i++) {
+        uint16_t len = bench_lengths[i];
+        bench_step(&bench, &platform, len, false);
+        bench_step(&bench, &platform, len, true);
+        bench_spawn(&bench, len);
+        bench_playfield(&bench, &platform, len, false);
+        bench_playfield(&bench, &platform, len, true);
+        bench_render(&bench, len, GameStateLife);
+        bench_render(&bench, len, GameStatePause);
+        bench_frame_latch(&bench, len);
+        bench_save_load(&bench, len);
+    }
+    bench_arena(&bench, &platform);
+
+    if(bench.format == BenchFormatJson) {
+        printf("\n]}\n");
+    }
+
+    free(bench.timings);
+    return 0;
+}
@@ -0,0 +1,101 @@
+#include "snake_policy.h"
+
+#include <string.h>
+
+static const char* const snake_policy_names[SnakePolicyCount] = {
+    "random",
+    "greedy",
+    "autopilot",
+};
+
+void snake_player_init(SnakePlayer* const player, SnakePolicy policy, uint32_t seed) {
+    player->policy = policy;
+    player->rng = seed ? seed : 1;
+    if(policy == SnakePolicyAutopilot) {
+        snake_autopilot_init(&player->pilot);
+    }
+}
+
+static uint32_t snake_player_random(SnakePlayer* const player) {
+    // The game's generator on the player's own state
+    return snake_game_xorshift(&player->rng);
+}
+
+static bool snake_player_is_free(SnakeState const* const snake_state, Direction direction) {
+    // A U-turn is ignored by the rules, it would mean going straight on
+    if((direction + 2) % 4 == snake_state->currentMovement) {
+        return false;
+    }
+    Point next = snake_game_neighbour(snake_state->head_point, direction);
+    return !snake_game_collision_with_walls(snake_state, next) &&
+           !snake_game_collision_with_tail(snake_state, next);
+}
+
+static Direction snake_player_greedy(SnakeState const* const snake_state) {
+    Point head = snake_state->head_point;
+    Point fruit = snake_state->fruit;
+    Direction order[8];
+    uint8_t count = 0;
+    if(fruit.x > head.x) {
+        order[count++] = DirectionRight;
+    }
+    if(fruit.x < head.x) {
+        order[count++] = DirectionLeft;
+    }
+    if(fruit.y > head.y) {
+        order[count++] = DirectionDown;
+    }
+    if(fruit.y < head.y) {
+        order[count++] = DirectionUp;
+    }
+    for(uint8_t d = DirectionUp; d <= DirectionLeft; d++) {
+        order[count++] = d;
+    }
+
+    for(uint8_t i = 0; i < count; i++) {
+        if(snake_player_is_free(snake_state, order[i])) {
+            return order[i];
+        }
+    }
+    return snake_state->currentMovement;
+}
+
+static Direction
+    snake_player_wander(SnakePlayer* const player, SnakeState const* const snake_state) {
+    // Tries the directions from a random one on
+    uint8_t start = snake_player_random(player) % 4;
+    for(uint8_t i = 0; i < 4; i++) {
+        Direction direction = (start + i) % 4;
+        if(snake_player_is_free(snake_state, direction)) {
+            return direction;
+        }
+    }
+    return snake_state->currentMovement;
+}
+
+Direction snake_player_steer(SnakePlayer* const player, SnakeState const* const snake_state) {
+    switch(player->policy) {
+    case SnakePolicyRandom:
+        return snake_player_wander(player, snake_state);
+    case SnakePolicyGreedy:
+        return snake_player_greedy(snake_state);
+    case SnakePolicyAutopilot:
+        return snake_autopilot_steer(&player->pilot, snake_state);
+    case SnakePolicyCount:
+        break;
+    }
+    return snake_state->currentMovement;
+}
+
+const char* snake_policy_name(SnakePolicy policy) {
+    return policy < SnakePolicyCount ? snake_policy_names[policy] : "?";
+}
+
+SnakePolicy snake_policy_parse(const char* name) {
+    for(uint8_t policy = 0; policy < SnakePolicyCount; policy++) {
+        if(!strcmp(name, snake_policy_names[policy])) {
+            return policy;
+        }
+    }
+    return SnakePolicyCount;
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+// Players for headless games on the host: they pick the direction for the next step,
+// which the caller queues with snake_game_queue_turn before snake_game_process_game_step.
+
+#include "snake_autopilot.h"
+#include "snake_game.h"
+
+typedef enum {
+    SnakePolicyRandom, // any direction that doesn't end the game right away
+    SnakePolicyGreedy, // heads for the fruit, takes any free cell when that way is blocked
+    SnakePolicyAutopilot, // snake_autopilot.h
+    SnakePolicyCount,
+} SnakePolicy;
+
+typedef struct {
+    SnakePolicy policy;
+    uint32_t rng; // the random policy's own, the game's generator is left alone
+    SnakeAutopilot pilot;
+} SnakePlayer;
+
+void snake_player_init(SnakePlayer* const player, SnakePolicy policy, uint32_t seed);
+
+Direction snake_player_steer(SnakePlayer* const player, SnakeState const* const snake_state);
+
+const char* snake_policy_name(SnakePolicy policy);
+
+// Returns SnakePolicyCount for an unknown name
+SnakePolicy snake_policy_parse(const char* name);
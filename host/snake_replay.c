@@ -0,0 +1,250 @@
+// Replays recorded games as fast as the host runs them, and records games to replay.
+//
+//   build/snake_replay [-n runs] <file>                 replay a snake2.replay
+//   build/snake_replay -g seed [-e] [-p policy] [-s steps] <file>
+//                                                       record a game played by a bot
+//
+// The bot is the greedy policy of snake_policy.h by default, -a is short for -p autopilot.
+//
+// A replay prints the steps played, the final length and state, the time per step and
+// a checksum of the final state. The same file gives the same checksum on every run and
+// on every machine, a recorded bot game gives the checksum printed when recording it.
+
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "snake_game.h"
+#include "snake_journal.h"
+#include "snake_policy.h"
+#include "snake_profile.h"
+#include "snake_save.h"
+
+static uint32_t replay_get_ms(void* ctx) {
+    (void)ctx;
+    return 0;
+}
+
+static uint32_t replay_seed(void* ctx) {
+    return *(uint32_t*)ctx;
+}
+
+static void replay_feedback(void* ctx, SnakeFeedback feedback) {
+    (void)ctx;
+    (void)feedback;
+}
+
+static uint64_t replay_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+static const char* replay_state_name(GameState state) {
+    switch(state) {
+    case GameStateLife:
+        return "life";
+    case GameStatePause:
+        return "pause";
+    case GameStateLastChance:
+        return "last_chance";
+    case GameStateGameOver:
+        return "game_over";
+    }
+    return "?";
+}
+
+static uint32_t replay_checksum(SnakeState const* const snake_state) {
+    static uint8_t buffer[SNAKE_SAVE_MAX_SIZE];
+    size_t size = snake_save_encode(snake_state, buffer, sizeof(buffer));
+    return snake_save_crc32(buffer, size);
+}
+
+static int replay_record(
+    const char* path,
+    uint32_t seed,
+    bool endless,
+    SnakePolicy policy,
+    uint32_t max_steps) {
+    static SnakeState snake_state;
+    static SnakeJournal journal;
+    static SnakePlayer player;
+    SnakePlatform platform = {
+        .get_ms = replay_get_ms,
+        .random = replay_seed,
+        .feedback = replay_feedback,
+        .ctx = &seed,
+    };
+
+    snake_game_init_game(&snake_state, &platform);
+    snake_state.Endlessmode = endless;
+    snake_journal_start(&journal, &snake_state);
+    snake_player_init(&player, policy, seed);
+
+    uint64_t start = replay_now_ns();
+    while(snake_state.state != GameStateGameOver && snake_state.steps < max_steps) {
+        Direction direction = snake_player_steer(&player, &snake_state);
+        if(snake_game_queue_turn(&snake_state, direction) == SnakeTurnQueued) {
+            snake_journal_record(&journal, &snake_state, (SnakeJournalEvent)direction);
+        }
+        snake_game_process_game_step(&snake_state, &platform);
+    }
+    uint64_t elapsed = replay_now_ns() - start;
+
+    size_t size = snake_journal_finish(&journal, &snake_state);
+    FILE* file = fopen(path, "wb");
+    if(!file || fwrite(journal.data, 1, size, file) != size) {
+        fprintf(stderr, "cannot write %s\n", path);
+        if(file) {
+            fclose(file);
+        }
+        return 1;
+    }
+    fclose(file);
+
+    printf(
+        "recorded %s: %zu bytes, steps %u, len %u, state %s%s, checksum %08x\n",
+        path,
+        size,
+        snake_state.steps,
+        snake_state.len,
+        replay_state_name(snake_state.state),
+        journal.truncated ? " (truncated)" : "",
+        replay_checksum(&snake_state));
+    if(policy == SnakePolicyAutopilot) {
+        SnakeAutopilot* pilot = &player.pilot;
+        printf(
+            "autopilot: %s, %.1f ns/step, shortcuts %u, paths found %u, over budget %u\n",
+            snake_state.state != GameStateGameOver ? "stopped" :
+            snake_game_is_won(&snake_state)        ? "won" :
+                                                     "lost",
+            pilot->steps ? (double)elapsed / pilot->steps : 0.0,
+            pilot->shortcuts,
+            pilot->searches,
+            pilot->overruns);
+    }
+#ifdef SNAKE_PROFILE
+    static char report[2048];
+    snake_profile_format_report(report, sizeof(report));
+    fputs(report, stdout);
+#endif
+    return 0;
+}
+
+static int replay_play(const char* path, uint32_t runs) {
+    static uint8_t data[SNAKE_JOURNAL_MAX_SIZE];
+    static SnakeState snake_state;
+    FILE* file = fopen(path, "rb");
+    if(!file) {
+        fprintf(stderr, "cannot open %s\n", path);
+        return 1;
+    }
+    size_t size = fread(data, 1, sizeof(data), file);
+    fclose(file);
+
+    uint32_t seed = 1;
+    SnakePlatform platform = {
+        .get_ms = replay_get_ms,
+        .random = replay_seed,
+        .feedback = replay_feedback,
+        .ctx = &seed,
+    };
+
+    uint64_t best_ns = UINT64_MAX;
+    uint64_t total_ns = 0;
+    uint32_t steps = 0;
+    uint32_t checksum = 0;
+    for(uint32_t run = 0; run < runs; run++) {
+        SnakeReplay replay;
+        if(!snake_replay_start(&replay, &snake_state, data, size)) {
+            fprintf(stderr, "%s is not a valid replay\n", path);
+            return 1;
+        }
+        uint32_t start_step = snake_state.steps;
+
+        uint64_t start = replay_now_ns();
+        while(snake_replay_step(&replay, &snake_state, &platform)) {
+        }
+        uint64_t elapsed = replay_now_ns() - start;
+
+        total_ns += elapsed;
+        if(elapsed < best_ns) {
+            best_ns = elapsed;
+        }
+        steps = snake_state.steps - start_step;
+
+        uint32_t run_checksum = replay_checksum(&snake_state);
+        if(run && run_checksum != checksum) {
+            fprintf(stderr, "run %u diverged: %08x != %08x\n", run, run_checksum, checksum);
+            return 1;
+        }
+        checksum = run_checksum;
+    }
+
+    printf(
+        "replayed %s: steps %u, len %u, state %s, %.1f ns/step (best %.1f), checksum %08x\n",
+        path,
+        steps,
+        snake_state.len,
+        replay_state_name(snake_state.state),
+        steps ? (double)total_ns / runs / steps : 0.0,
+        steps ? (double)best_ns / steps : 0.0,
+        checksum);
+#ifdef SNAKE_PROFILE
+    static char report[2048];
+    snake_profile_format_report(report, sizeof(report));
+    fputs(report, stdout);
+#endif
+    return 0;
+}
+
+static void replay_usage(const char* name) {
+    fprintf(stderr, "usage: %s [-n runs] <file>\n", name);
+    fprintf(stderr, "       %s -g seed [-e] [-a | -p policy] [-s steps] <file>\n", name);
+}
+
+int main(int argc, char** argv) {
+    uint32_t runs = 1;
+    bool record = false;
+    uint32_t seed = 0;
+    bool endless = false;
+    SnakePolicy policy = SnakePolicyGreedy;
+    uint32_t max_steps = 200000;
+    const char* path = NULL;
+
+    for(int i = 1; i < argc; i++) {
+        if(!strcmp(argv[i], "-n") && i + 1 < argc) {
+            runs = strtoul(argv[++i], NULL, 10);
+        } else if(!strcmp(argv[i], "-g") && i + 1 < argc) {
+            record = true;
+            seed = strtoul(argv[++i], NULL, 0);
+        } else if(!strcmp(argv[i], "-e")) {
+            endless = true;
+        } else if(!strcmp(argv[i], "-a")) {
+            policy = SnakePolicyAutopilot;
+        } else if(!strcmp(argv[i], "-p") && i + 1 < argc) {
+            policy = snake_policy_parse(argv[++i]);
+            if(policy == SnakePolicyCount) {
+                replay_usage(argv[0]);
+                return 1;
+            }
+        } else if(!strcmp(argv[i], "-s") && i + 1 < argc) {
+            max_steps = strtoul(argv[++i], NULL, 10);
+        } else if(argv[i][0] != '-' && !path) {
+            path = argv[i];
+        } else {
+            replay_usage(argv[0]);
+            return 1;
+        }
+    }
+    if(!path || !runs) {
+        replay_usage(argv[0]);
+        return 1;
+    }
+
+    return record ? replay_record(path, seed, endless, policy, max_steps) :
+                    replay_play(path, runs);
+}
@@ -0,0 +1,375 @@
+// Headless self-play: many independent games on every core, for statistics about the
+// rules and the policies at a scale the Flipper can't reach, and as a throughput
+// benchmark of the game core.
+//
+//   build/snake_sim [-g games] [-t threads] [-p policy] [-s seed] [-m max_steps] [-e]
+//                   [-l level] [-c chunk] [-f text|csv]
+//
+// Game i is seeded from the base seed and i alone, so the totals don't depend on the
+// number of threads or on which thread played which game. The threads take games from
+// a shared counter a chunk at a time and keep their own totals, added up at the end.
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "snake_game.h"
+#include "snake_levels.h"
+#include "snake_policy.h"
+
+// Every thread would add to the same profile counters, which take one thread only
+#ifdef SNAKE_PROFILE
+#error "snake_sim can't be built with SNAKE_PROFILE, see snake_profile.h"
+#endif
+
+#define SIM_START_LEN 7
+#define SIM_SCORES (MAX_SNAKE_LEN - SIM_START_LEN) // a won game scores MAX_SNAKE_LEN - 8
+
+typedef enum {
+    SimFormatText,
+    SimFormatCsv,
+} SimFormat;
+
+typedef struct {
+    uint32_t games;
+    uint32_t threads;
+    SnakePolicy policy;
+    uint32_t seed;
+    uint32_t max_steps; // a game still running after this many steps is stopped
+    bool endless;
+    uint32_t level;
+    uint32_t chunk; // games a thread takes at a time
+    SimFormat format;
+} SimConfig;
+
+typedef struct {
+    uint64_t games;
+    uint64_t won;
+    uint64_t stopped;
+    uint64_t steps;
+    uint32_t steps_min;
+    uint32_t steps_max;
+    uint64_t score_sum;
+    uint32_t scores[SIM_SCORES]; // games per final score
+} SimTotals;
+
+typedef struct {
+    SimConfig const* config;
+    atomic_uint* next_game;
+    SimTotals totals;
+    SnakeState snake_state;
+    SnakePlayer player;
+    pthread_t thread;
+} SimWorker;
+
+static uint32_t sim_get_ms(void* ctx) {
+    (void)ctx;
+    return 0;
+}
+
+static uint32_t sim_seed(void* ctx) {
+    return *(uint32_t*)ctx;
+}
+
+static void sim_feedback(void* ctx, SnakeFeedback feedback) {
+    (void)ctx;
+    (void)feedback;
+}
+
+static uint64_t sim_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+// Spreads consecutive game numbers over the whole seed space (murmur3 finalizer)
+static uint32_t sim_game_seed(uint32_t base, uint32_t game) {
+    uint32_t x = base + game * 0x9E3779B9U;
+    x ^= x >> 16;
+    x *= 0x85EBCA6BU;
+    x ^= x >> 13;
+    x *= 0xC2B2AE35U;
+    x ^= x >> 16;
+    return x ? x : 1;
+}
+
+static void sim_play(SimWorker* const worker, uint32_t game) {
+    SimConfig const* config = worker->config;
+    SnakeState* snake_state = &worker->snake_state;
+    uint32_t seed = sim_game_seed(config->seed, game);
+    SnakePlatform platform = {
+        .get_ms = sim_get_ms,
+        .random = sim_seed,
+        .feedback = sim_feedback,
+        .ctx = &seed,
+    };
+
+    snake_game_init_game(snake_state, &platform);
+    snake_game_load_level(snake_state, config->level);
+    snake_state->Endlessmode = config->endless;
+    snake_player_init(&worker->player, config->policy, seed ^ 0x5BD1E995U);
+    while(snake_state->state != GameStateGameOver && snake_state->steps < config->max_steps) {
+        snake_game_queue_turn(snake_state, snake_player_steer(&worker->player, snake_state));
+        snake_game_process_game_step(snake_state, &platform);
+    }
+
+    SimTotals* totals = &worker->totals;
+    uint32_t steps = snake_state->steps;
+    uint16_t score = snake_state->len - SIM_START_LEN;
+    totals->games++;
+    if(snake_state->state != GameStateGameOver) {
+        totals->stopped++;
+    } else if(snake_game_is_won(snake_state)) {
+        totals->won++;
+    }
+    totals->steps += steps;
+    if(totals->games == 1 || steps < totals->steps_min) {
+        totals->steps_min = steps;
+    }
+    if(steps > totals->steps_max) {
+        totals->steps_max = steps;
+    }
+    totals->score_sum += score;
+    totals->scores[score]++;
+}
+
+static void* sim_worker(void* ctx) {
+    SimWorker* worker = ctx;
+    SimConfig const* config = worker->config;
+    for(;;) {
+        uint32_t first =
+            atomic_fetch_add_explicit(worker->next_game, config->chunk, memory_order_relaxed);
+        if(first >= config->games) {
+            break;
+        }
+        uint32_t last = first + config->chunk;
+        if(last > config->games) {
+            last = config->games;
+        }
+        for(uint32_t game = first; game < last; game++) {
+            sim_play(worker, game);
+        }
+    }
+    return NULL;
+}
+
+static void sim_add(SimTotals* const sum, SimTotals const* const totals) {
+    if(!totals->games) {
+        return;
+    }
+    if(!sum->games || totals->steps_min < sum->steps_min) {
+        sum->steps_min = totals->steps_min;
+    }
+    if(totals->steps_max > sum->steps_max) {
+        sum->steps_max = totals->steps_max;
+    }
+    sum->games += totals->games;
+    sum->won += totals->won;
+    sum->stopped += totals->stopped;
+    sum->steps += totals->steps;
+    sum->score_sum += totals->score_sum;
+    for(uint16_t score = 0; score < SIM_SCORES; score++) {
+        sum->scores[score] += totals->scores[score];
+    }
+}
+
+// Lowest score at least `percent` of the games didn't beat
+static uint16_t sim_percentile(SimTotals const* const totals, uint32_t percent) {
+    uint64_t rank = (totals->games * percent + 99) / 100;
+    uint64_t seen = 0;
+    for(uint16_t score = 0; score < SIM_SCORES; score++) {
+        seen += totals->scores[score];
+        if(seen >= rank && seen) {
+            return score;
+        }
+    }
+    return SIM_SCORES - 1;
+}
+
+static void
+    sim_print(SimConfig const* const config, SimTotals const* const totals, double seconds) {
+    double games = totals->games ? (double)totals->games : 1.0;
+    double rate = seconds > 0 ? totals->steps / seconds : 0.0;
+    uint16_t max_score = 0;
+    for(uint16_t score = 0; score < SIM_SCORES; score++) {
+        if(totals->scores[score]) {
+            max_score = score;
+        }
+    }
+
+    if(config->format == SimFormatCsv) {
+        printf("policy,board,level,games,threads,seed,endless,won,stopped,score_mean,score_p10,"
+               "score_p50,score_p90,score_p99,score_max,steps,steps_mean,steps_min,steps_max,"
+               "seconds,steps_per_s\n");
+        printf(
+            "%s,%ux%u,%u,%lu,%u,%u,%d,%lu,%lu,%.2f,%u,%u,%u,%u,%u,%lu,%.1f,%u,%u,%.3f,%.0f\n",
+            snake_policy_name(config->policy),
+            SNAKE_BOARD_WIDTH,
+            SNAKE_BOARD_HEIGHT,
+            config->level,
+            (unsigned long)totals->games,
+            config->threads,
+            config->seed,
+            config->endless,
+            (unsigned long)totals->won,
+            (unsigned long)totals->stopped,
+            totals->score_sum / games,
+            sim_percentile(totals, 10),
+            sim_percentile(totals, 50),
+            sim_percentile(totals, 90),
+            sim_percentile(totals, 99),
+            max_score,
+            (unsigned long)totals->steps,
+            totals->steps / games,
+            totals->steps_min,
+            totals->steps_max,
+            seconds,
+            rate);
+        return;
+    }
+
+    printf(
+        "%s on %ux%u, level %s%s: %lu games, %u threads, seed %u\n",
+        snake_policy_name(config->policy),
+        SNAKE_BOARD_WIDTH,
+        SNAKE_BOARD_HEIGHT,
+        snake_levels[config->level].name,
+        config->endless ? " (endless)" : "",
+        (unsigned long)totals->games,
+        config->threads,
+        config->seed);
+    printf(
+        "won %lu (%.2f%%), stopped after %u steps %lu\n",
+        (unsigned long)totals->won,
+        totals->won * 100.0 / games,
+        config->max_steps,
+        (unsigned long)totals->stopped);
+    printf(
+        "score: mean %.2f, p10 %u, p50 %u, p90 %u, p99 %u, max %u\n",
+        totals->score_sum / games,
+        sim_percentile(totals, 10),
+        sim_percentile(totals, 50),
+        sim_percentile(totals, 90),
+        sim_percentile(totals, 99),
+        max_score);
+    printf(
+        "steps per game: mean %.1f, min %u, max %u\n",
+        totals->steps / games,
+        totals->steps_min,
+        totals->steps_max);
+    printf(
+        "%lu steps in %.3f s: %.2f M steps/s, %.2f M per thread\n",
+        (unsigned long)totals->steps,
+        seconds,
+        rate / 1e6,
+        rate / 1e6 / config->threads);
+}
+
+static void sim_usage(const char* name) {
+    fprintf(
+        stderr,
+        "usage: %s [-g games] [-t threads] [-p random|greedy|autopilot] [-s seed]\n"
+        "       [-m max_steps] [-e] [-l level] [-c chunk] [-f text|csv]\n",
+        name);
+}
+
+int main(int argc, char** argv) {
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    SimConfig config = {
+        .games = 10000,
+        .threads = cores > 0 ? (uint32_t)cores : 1,
+        .policy = SnakePolicyGreedy,
+        .seed = 1,
+        .max_steps = 1000000,
+        .endless = false,
+        .chunk = 16,
+        .format = SimFormatText,
+    };
+
+    for(int i = 1; i < argc; i++) {
+        if(!strcmp(argv[i], "-g") && i + 1 < argc) {
+            config.games = strtoul(argv[++i], NULL, 10);
+        } else if(!strcmp(argv[i], "-t") && i + 1 < argc) {
+            config.threads = strtoul(argv[++i], NULL, 10);
+        } else if(!strcmp(argv[i], "-p") && i + 1 < argc) {
+            config.policy = snake_policy_parse(argv[++i]);
+        } else if(!strcmp(argv[i], "-s") && i + 1 < argc) {
+            config.seed = strtoul(argv[++i], NULL, 0);
+        } else if(!strcmp(argv[i], "-m") && i + 1 < argc) {
+            config.max_steps = strtoul(argv[++i], NULL, 10);
+        } else if(!strcmp(argv[i], "-e")) {
+            config.endless = true;
+        } else if(!strcmp(argv[i], "-l") && i + 1 < argc) {
+            config.level = strtoul(argv[++i], NULL, 10);
+        } else if(!strcmp(argv[i], "-c") && i + 1 < argc) {
+            config.chunk = strtoul(argv[++i], NULL, 10);
+        } else if(!strcmp(argv[i], "-f") && i + 1 < argc) {
+            i++;
+            if(!strcmp(argv[i], "csv")) {
+                config.format = SimFormatCsv;
+            } else if(strcmp(argv[i], "text")) {
+                sim_usage(argv[0]);
+                return 1;
+            }
+        } else {
+            sim_usage(argv[0]);
+            return 1;
+        }
+    }
+    // The autopilot's cycle needs the plain board
+    if(!config.threads || !config.chunk || config.policy == SnakePolicyCount ||
+       config.level >= snake_level_count ||
+       (config.level && config.policy == SnakePolicyAutopilot)) {
+        sim_usage(argv[0]);
+        return 1;
+    }
+
+    atomic_uint next_game;
+    atomic_init(&next_game, 0);
+    // One allocation per worker keeps their totals on separate cache lines
+    uint32_t allocated = config.threads;
+    SimWorker** workers = calloc(allocated, sizeof(SimWorker*));
+    for(uint32_t i = 0; i < allocated; i++) {
+        workers[i] = calloc(1, sizeof(SimWorker));
+        workers[i]->config = &config;
+        workers[i]->next_game = &next_game;
+    }
+
+    uint64_t start = sim_now_ns();
+    uint32_t started = 0;
+    for(; started < config.threads; started++) {
+        if(pthread_create(&workers[started]->thread, NULL, sim_worker, workers[started])) {
+            fprintf(stderr, "cannot start thread %u, going on with %u\n", started, started);
+            break;
+        }
+    }
+    if(!started) {
+        // Nothing to share the work with, this thread plays every game
+        sim_worker(workers[0]);
+        started = 1;
+    } else {
+        for(uint32_t i = 0; i < started; i++) {
+            pthread_join(workers[i]->thread, NULL);
+        }
+    }
+    double seconds = (sim_now_ns() - start) / 1e9;
+    config.threads = started;
+
+    static SimTotals totals;
+    for(uint32_t i = 0; i < started; i++) {
+        sim_add(&totals, &workers[i]->totals);
+    }
+    sim_print(&config, &totals, seconds);
+
+    for(uint32_t i = 0; i < allocated; i++) {
+        free(workers[i]);
+    }
+    free(workers);
+    return 0;
+}
@@ -0,0 +1,421 @@
+// Checks of the game core that don't need a golden value, run by `make -C host test`
+// next to the golden replays of replays.py.
+//
+//   build/snake_test
+//
+// Bot games on every level, classic and endless, are saved and loaded again at many
+// points: a decoded save has to be the game it was made from and encode to the same
+// bytes. The same games are played through snake_rewind_step and stepped back: every
+// rewind has to give the state the game was in that many steps earlier, and playing
+// the same turns again from there the state it was rewound from. Arena games have to
+// keep their free cells counted right and their fruits off the snakes. New fruits have to
+// be spread evenly over the free cells. A give-up has to stop the play time, and its
+// replay has to end the same way.
+// Prints what failed and exits with 1 if anything did.
+
+#include <stdio.h>
+#include <string.h>
+
+#include "snake_arena.h"
+#include "snake_game.h"
+#include "snake_journal.h"
+#include "snake_levels.h"
+#include "snake_policy.h"
+#include "snake_rewind.h"
+#include "snake_save.h"
+
+#define TEST_SEEDS 32
+#define TEST_MAX_STEPS 3000
+#define TEST_SAVE_EVERY 37
+#define TEST_REWIND_EVERY 211
+#define TEST_SPAWN_DRAWS 200 // per free cell
+
+typedef struct {
+    const char* name; // of the game, for the failures
+    uint32_t checks;
+    uint32_t failures;
+} TestRun;
+
+static TestRun test_run;
+
+#define TEST_CHECK(cond, ...)                                    \
+    do {                                                         \
+        test_run.checks++;                                       \
+        if(!(cond)) {                                            \
+            test_run.failures++;                                 \
+            if(test_run.failures <= 20) {                        \
+                printf("FAIL %s: ", test_run.name);              \
+                printf(__VA_ARGS__);                             \
+                printf("\n");                                    \
+            }                                                    \
+        }                                                        \
+    } while(0)
+
+static uint32_t test_get_ms(void* ctx) {
+    (void)ctx;
+    return 0;
+}
+
+static uint32_t test_seed(void* ctx) {
+    return *(uint32_t*)ctx;
+}
+
+static void test_feedback(void* ctx, SnakeFeedback feedback) {
+    (void)ctx;
+    (void)feedback;
+}
+
+static uint32_t test_now_ms;
+
+static uint32_t test_clock_ms(void* ctx) {
+    (void)ctx;
+    return test_now_ms;
+}
+
+static bool test_same_point(Point a, Point b) {
+    return a.x == b.x && a.y == b.y;
+}
+
+// Everything a game is, including what snake_game_restore derives from it, but not the
+// changes of the last step or the turns queued behind nextMovement
+static bool test_same(SnakeState const* const a, SnakeState const* const b) {
+    if(a->len != b->len || a->level != b->level || a->state != b->state ||
+       a->currentMovement != b->currentMovement || a->nextMovement != b->nextMovement ||
+       a->Endlessmode != b->Endlessmode || a->rng != b->rng || a->steps != b->steps ||
+       a->free_count != b->free_count || a->open_cells != b->open_cells ||
+       !test_same_point(a->fruit, b->fruit) || !test_same_point(a->head_point, b->head_point) ||
+       !test_same_point(a->tail_point, b->tail_point)) {
+        return false;
+    }
+    uint16_t i = a->head;
+    uint16_t j = b->head;
+    for(uint16_t k = 1; k < a->len; k++) {
+        if(snake_game_body_direction(a, i) != snake_game_body_direction(b, j)) {
+            return false;
+        }
+        i = snake_game_next_index(i);
+        j = snake_game_next_index(j);
+    }
+    return !memcmp(a->occupied, b->occupied, sizeof(a->occupied)) &&
+           !memcmp(a->walls, b->walls, sizeof(a->walls)) &&
+           !memcmp(a->row_free, b->row_free, sizeof(a->row_free));
+}
+
+static void test_new_game(
+    SnakeState* const snake_state,
+    SnakePlayer* const player,
+    SnakePlatform const* const platform,
+    uint8_t level,
+    bool endless) {
+    uint32_t seed = *(uint32_t*)platform->ctx;
+    snake_game_init_game(snake_state, platform);
+    snake_game_load_level(snake_state, level);
+    snake_state->Endlessmode = endless;
+    // The random policy, so the games also run into the walls and their own tail
+    snake_player_init(player, SnakePolicyRandom, seed ^ 0x5BD1E995U);
+}
+
+static void test_save_round_trip(SnakeState const* const snake_state) {
+    static uint8_t buffer[SNAKE_SAVE_MAX_SIZE];
+    static uint8_t again[SNAKE_SAVE_MAX_SIZE];
+    static SnakeState loaded;
+
+    size_t size = snake_save_encode(snake_state, buffer, sizeof(buffer));
+    TEST_CHECK(size, "step %u: the save doesn't fit", snake_state->steps);
+    if(!size) {
+        return;
+    }
+
+    memset(&loaded, 0xA5, sizeof(loaded));
+    bool decoded = snake_save_decode(&loaded, buffer, size);
+    TEST_CHECK(decoded, "step %u: the save doesn't load", snake_state->steps);
+    if(!decoded) {
+        return;
+    }
+    TEST_CHECK(
+        test_same(&loaded, snake_state), "step %u: the loaded game differs", snake_state->steps);
+
+    size_t again_size = snake_save_encode(&loaded, again, sizeof(again));
+    TEST_CHECK(
+        again_size == size && !memcmp(again, buffer, size),
+        "step %u: the loaded game saves differently",
+        snake_state->steps);
+
+    // Any changed byte of the payload has to fail the CRC
+    size_t flip = SNAKE_SAVE_HEADER_SIZE + snake_state->steps % (size - SNAKE_SAVE_HEADER_SIZE);
+    buffer[flip] ^= 0x10;
+    TEST_CHECK(
+        !snake_save_decode(&loaded, buffer, size),
+        "step %u: a save with byte %zu changed loads",
+        snake_state->steps,
+        flip);
+}
+
+static void test_saves(SnakePlatform const* const platform, uint8_t level, bool endless) {
+    static SnakeState snake_state;
+    static SnakePlayer player;
+
+    test_new_game(&snake_state, &player, platform, level, endless);
+    test_save_round_trip(&snake_state);
+    while(snake_state.state != GameStateGameOver && snake_state.steps < TEST_MAX_STEPS) {
+        snake_game_queue_turn(&snake_state, snake_player_steer(&player, &snake_state));
+        snake_game_process_game_step(&snake_state, platform);
+        if(snake_state.steps % TEST_SAVE_EVERY == 0) {
+            test_save_round_trip(&snake_state);
+        }
+    }
+    test_save_round_trip(&snake_state);
+}
+
+// The state as a rewind or a load gives it back
+static void test_snapshot(SnakeState* const copy, SnakeState const* const snake_state) {
+    *copy = *snake_state;
+    memset(&copy->changes, 0, sizeof(copy->changes));
+    copy->turn_count = 0;
+}
+
+static void test_rewinds(SnakePlatform const* const platform, uint8_t level, bool endless) {
+    // Every state since the oldest step the rewind keeps, taken right before each step
+    static SnakeState before[SNAKE_REWIND_STEPS + 1];
+    static Direction turns[SNAKE_REWIND_STEPS + 1];
+    static bool turned[SNAKE_REWIND_STEPS + 1];
+    static SnakeState snake_state;
+    static SnakeState rewound_from;
+    static SnakePlayer player;
+    static SnakeRewind rewind;
+    const uint32_t ring = SNAKE_REWIND_STEPS + 1;
+
+    test_new_game(&snake_state, &player, platform, level, endless);
+    snake_rewind_reset(&rewind);
+    uint32_t played = 0;
+    while(snake_state.state != GameStateGameOver && snake_state.steps < TEST_MAX_STEPS) {
+        uint32_t slot = played % ring;
+        Direction direction = snake_player_steer(&player, &snake_state);
+        turned[slot] = snake_game_queue_turn(&snake_state, direction) == SnakeTurnQueued;
+        turns[slot] = direction;
+        test_snapshot(&before[slot], &snake_state);
+        snake_rewind_step(&rewind, &snake_state, platform);
+        played++;
+
+        bool last = snake_state.state == GameStateGameOver || snake_state.steps == TEST_MAX_STEPS;
+        if(played % TEST_REWIND_EVERY && !last) {
+            continue;
+        }
+
+        // Back by a different amount each time, all the way on the last one
+        uint16_t kept = rewind.step_count;
+        uint16_t back = last ? kept : 1 + played % kept;
+        test_snapshot(&rewound_from, &snake_state);
+        uint16_t undone = snake_rewind_back(&rewind, &snake_state, back);
+        TEST_CHECK(undone == back, "step %u: rewound %u of %u", played, undone, back);
+        if(undone != back) {
+            return;
+        }
+        TEST_CHECK(
+            test_same(&snake_state, &before[(played - back) % ring]),
+            "step %u: %u steps back isn't the game %u steps earlier",
+            played,
+            back,
+            back);
+
+        // The same turns again lead to the same game
+        for(uint32_t step = played - back; step < played; step++) {
+            if(step != played - back && turned[step % ring]) {
+                snake_game_queue_turn(&snake_state, turns[step % ring]);
+            }
+            snake_rewind_step(&rewind, &snake_state, platform);
+        }
+        TEST_CHECK(
+            test_same(&snake_state, &rewound_from),
+            "step %u: replaying %u rewound steps gives another game",
+            played,
+            back);
+    }
+}
+
+// New fruits have to land on every free cell and on nothing else, each about as often.
+// The counts are checked with a chi-square test against 6 standard deviations over what
+// a uniform draw gives, on the board of the build: BIG_BOARD=1 tests the big one.
+static void test_spawn(SnakePlatform const* const platform, uint8_t level) {
+    static uint32_t counts[SNAKE_BOARD_CELLS];
+    static SnakeState snake_state;
+    static SnakePlayer player;
+
+    // A snake part of the way into a game, so the free cells aren't one block
+    test_new_game(&snake_state, &player, platform, level, true);
+    while(snake_state.steps < 500) {
+        snake_game_queue_turn(&snake_state, snake_player_steer(&player, &snake_state));
+        snake_game_process_game_step(&snake_state, platform);
+    }
+
+    memset(counts, 0, sizeof(counts));
+    uint32_t draws = snake_state.free_count * TEST_SPAWN_DRAWS;
+    for(uint32_t i = 0; i < draws; i++) {
+        Point p = snake_game_get_new_fruit(&snake_state);
+        bool free = !snake_game_collision_with_walls(&snake_state, p) &&
+                    !snake_game_is_occupied(&snake_state, p);
+        TEST_CHECK(free, "a fruit on %u,%u, which isn't free", p.x, p.y);
+        if(!free) {
+            return;
+        }
+        counts[snake_game_cell(p)]++;
+    }
+
+    uint16_t missed = 0;
+    double chi2 = 0;
+    for(uint8_t y = 0; y < SNAKE_BOARD_HEIGHT; y++) {
+        for(uint8_t x = 0; x < SNAKE_BOARD_WIDTH; x++) {
+            Point p = {.x = x, .y = y};
+            if(snake_game_is_wall(&snake_state, p) || snake_game_is_occupied(&snake_state, p)) {
+                continue;
+            }
+            double off = (double)counts[snake_game_cell(p)] - TEST_SPAWN_DRAWS;
+            chi2 += off * off / TEST_SPAWN_DRAWS;
+            missed += !counts[snake_game_cell(p)];
+        }
+    }
+    double dof = snake_state.free_count - 1;
+    TEST_CHECK(!missed, "%u free cells never got a fruit", missed);
+    TEST_CHECK(
+        chi2 < dof || (chi2 - dof) * (chi2 - dof) < 36 * 2 * dof,
+        "chi-square %.0f over %u free cells, not uniform",
+        chi2,
+        snake_state.free_count);
+}
+
+// The free counts of the arena have to match the board after every step, and no fruit
+// may lie under a snake
+static void test_arena(SnakePlatform const* const platform) {
+    static SnakeArena arena;
+    uint32_t rng = *(uint32_t*)platform->ctx;
+
+    snake_arena_init(&arena, platform);
+    while(arena.state == GameStateLife && arena.steps < TEST_MAX_STEPS) {
+        // The player wanders but doesn't run into anything it can see
+        SnakeArenaSnake const* player = &arena.snakes[SNAKE_ARENA_PLAYER];
+        Point head = player->points[player->head];
+        uint8_t first = snake_game_xorshift(&rng) % 4;
+        for(uint8_t d = 0; d < 4; d++) {
+            Point next = snake_game_neighbour(head, (first + d) % 4);
+            if(!snake_game_collision_with_frame(next) && !snake_arena_owner(&arena, next) &&
+               snake_arena_queue_turn(&arena, (first + d) % 4) == SnakeTurnQueued) {
+                break;
+            }
+        }
+        snake_arena_step(&arena, platform);
+
+        uint16_t free_count = 0;
+        bool rows_match = true;
+        for(uint8_t y = 0; y < SNAKE_BOARD_HEIGHT; y++) {
+            uint8_t row_free = 0;
+            for(uint8_t x = 0; x < SNAKE_BOARD_WIDTH; x++) {
+                Point p = {.x = x, .y = y};
+                bool fruit = false;
+                for(uint8_t f = 0; f < SNAKE_ARENA_FRUITS; f++) {
+                    fruit |= arena.fruits[f].x == x && arena.fruits[f].y == y;
+                }
+                TEST_CHECK(
+                    !fruit || !snake_arena_owner(&arena, p),
+                    "step %u: a fruit under a snake at %u,%u",
+                    arena.steps,
+                    x,
+                    y);
+                row_free += !fruit && !snake_arena_owner(&arena, p);
+            }
+            rows_match &= row_free == arena.row_free[y];
+            free_count += row_free;
+        }
+        TEST_CHECK(
+            rows_match && free_count == arena.free_count,
+            "step %u: %u free cells counted as %u",
+            arena.steps,
+            free_count,
+            arena.free_count);
+    }
+}
+
+// Giving up ends the play time like a crash does, in the game and in its replay
+static void test_give_up(SnakePlatform const* const platform) {
+    static SnakeState snake_state;
+    static SnakeState replayed;
+    static SnakeJournal journal;
+    SnakePlatform clocked = *platform;
+    clocked.get_ms = test_clock_ms;
+
+    test_run.name = "give up";
+    test_now_ms = 1000;
+    snake_game_init_game(&snake_state, &clocked);
+    snake_journal_start(&journal, &snake_state);
+    snake_game_timer_start(&snake_state, &clocked);
+    for(uint8_t step = 0; step < 20; step++) {
+        test_now_ms += 250;
+        snake_game_process_game_step(&snake_state, &clocked);
+    }
+    test_now_ms += 100;
+    snake_journal_apply(&snake_state, SnakeJournalEventGiveUp, &clocked);
+    snake_journal_record(&journal, &snake_state, SnakeJournalEventGiveUp);
+    test_now_ms += 5000;
+    TEST_CHECK(snake_state.state == GameStateGameOver, "the game isn't over");
+    TEST_CHECK(
+        !snake_state.clock.running && snake_clock_read_ms(&snake_state.clock, test_now_ms) == 5100,
+        "played %u ms, not 5100",
+        snake_clock_read_ms(&snake_state.clock, test_now_ms));
+
+    size_t size = snake_journal_finish(&journal, &snake_state);
+    SnakeReplay replay;
+    bool started = snake_replay_start(&replay, &replayed, journal.data, size);
+    TEST_CHECK(started, "the replay doesn't start");
+    if(!started) {
+        return;
+    }
+    snake_game_timer_start(&replayed, &clocked);
+    while(snake_replay_step(&replay, &replayed, &clocked)) {
+    }
+    TEST_CHECK(
+        test_same(&replayed, &snake_state) && !replayed.clock.running,
+        "the replay doesn't give up the same way");
+}
+
+int main(void) {
+    static char name[64];
+    uint32_t seed = 0;
+    SnakePlatform platform = {
+        .get_ms = test_get_ms,
+        .random = test_seed,
+        .feedback = test_feedback,
+        .ctx = &seed,
+    };
+
+    for(uint8_t level = 0; level < snake_level_count; level++) {
+        for(uint8_t endless = 0; endless < 2; endless++) {
+            for(seed = 1; seed <= TEST_SEEDS; seed++) {
+                snprintf(
+                    name,
+                    sizeof(name),
+                    "level %s%s, seed %u",
+                    snake_levels[level].name,
+                    endless ? " endless" : "",
+                    seed);
+                test_run.name = name;
+                test_saves(&platform, level, endless);
+                test_rewinds(&platform, level, endless);
+            }
+        }
+    }
+    for(uint8_t level = 0; level < snake_level_count; level++) {
+        seed = level + 1;
+        snprintf(name, sizeof(name), "spawn, level %s", snake_levels[level].name);
+        test_run.name = name;
+        test_spawn(&platform, level);
+    }
+    for(seed = 1; seed <= TEST_SEEDS; seed++) {
+        snprintf(name, sizeof(name), "arena, seed %u", seed);
+        test_run.name = name;
+        test_arena(&platform);
+    }
+
+    test_give_up(&platform);
+
+    printf("snake_test: %u checks, %u failed\n", test_run.checks, test_run.failures);
+    return test_run.failures ? 1 : 0;
+}
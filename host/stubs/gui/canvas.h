@@ -0,0 +1,81 @@
+#pragma once
+
+// Host stand-in for the firmware's <gui/canvas.h>.
+// It declares the subset of the Canvas API the game draws with and records
+// what was drawn: a 128x64 framebuffer plus draw call and pixel counters.
+// Text is only counted, glyphs are not rasterized.
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <gui/icon.h>
+
+typedef enum {
+    ColorWhite = 0x00,
+    ColorBlack = 0x01,
+    ColorXOR = 0x02,
+} Color;
+
+typedef enum {
+    FontPrimary,
+    FontSecondary,
+    FontKeyboard,
+    FontBigNumbers,
+} Font;
+
+typedef enum {
+    AlignLeft,
+    AlignRight,
+    AlignTop,
+    AlignBottom,
+    AlignCenter,
+} Align;
+
+typedef struct Canvas Canvas;
+
+void canvas_reset(Canvas* canvas);
+void canvas_set_color(Canvas* canvas, Color color);
+void canvas_set_font(Canvas* canvas, Font font);
+void canvas_draw_str_aligned(
+    Canvas* canvas,
+    int32_t x,
+    int32_t y,
+    Align horizontal,
+    Align vertical,
+    const char* str);
+void canvas_draw_dot(Canvas* canvas, int32_t x, int32_t y);
+void canvas_draw_box(Canvas* canvas, int32_t x, int32_t y, size_t width, size_t height);
+void canvas_draw_frame(Canvas* canvas, int32_t x, int32_t y, size_t width, size_t height);
+void canvas_draw_rframe(
+    Canvas* canvas,
+    int32_t x,
+    int32_t y,
+    size_t width,
+    size_t height,
+    size_t radius);
+void canvas_draw_xbm(
+    Canvas* canvas,
+    int32_t x,
+    int32_t y,
+    size_t width,
+    size_t height,
+    const uint8_t* bitmap);
+void canvas_draw_icon(Canvas* canvas, int32_t x, int32_t y, const Icon* icon);
+
+// Stub only
+
+#define CANVAS_STUB_WIDTH 128
+#define CANVAS_STUB_HEIGHT 64
+
+typedef struct {
+    uint32_t draw_calls; // every canvas_draw_* call
+    uint32_t state_changes; // canvas_set_color and canvas_set_font
+    uint32_t pixels; // pixels written by draw calls, text excluded
+    uint32_t text_chars;
+} CanvasStubStats;
+
+Canvas* canvas_stub_alloc(void);
+void canvas_stub_free(Canvas* canvas);
+const CanvasStubStats* canvas_stub_get_stats(const Canvas* canvas);
+// One byte per pixel, row major, 1 = black
+const uint8_t* canvas_stub_get_framebuffer(const Canvas* canvas);
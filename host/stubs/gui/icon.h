@@ -0,0 +1,12 @@
+#pragma once
+
+// Host stand-in for the firmware's <gui/icon.h>: a single-frame XBM image.
+// Instances are generated from images/ by host/icons.py.
+
+#include <stdint.h>
+
+typedef struct Icon {
+    uint16_t width;
+    uint16_t height;
+    const uint8_t* data;
+} Icon;
@@ -8,54 +8,111 @@
 #include <notification/notification_messages.h>
 #include <storage/storage.h>
 
+#include "snake_arena.h"
+#include "snake_autopilot.h"
+#include "snake_game.h"
+#include "snake_journal.h"
+#include "snake_levels.h"
+#include "snake_profile.h"
+#include "snake_render.h"
+#include "snake_rewind.h"
+#include "snake_saver.h"
+#include "snake_scheduler.h"
+
+// Endless games are saved this often while running, in case the app never gets to exit
+#define AUTOSAVE_PERIOD_S 30
+
+// The same feedback isn't played again sooner than this. Endless mode can hit the wall on
+// every step, a fail sequence each time would be one continuous buzz.
+#define FEEDBACK_FAIL_PERIOD_MS 500
+#define FEEDBACK_EAT_PERIOD_MS 100
+
+// On the pause and game over screens the backlight is left to the system after this long
+// without a key press
+#define IDLE_BACKLIGHT_TIMEOUT_S 30
+
+// A short Up on the pause or game over screen takes back this many steps, a second at the
+// normal speed
+#define REWIND_STEPS (1000 / SNAKE_SCHEDULER_NORMAL_MS)
+
+// Sound, vibro and LED for the game, handed to the notification service without waiting
+// for them to play
 typedef struct {
-    //    +-----x
-    //    |
-    //    |
-    //    y
-    uint8_t x;
-    uint8_t y;
-} Point;
-
-typedef enum {
-    GameStateLife,
-    GameStatePause,
-    GameStateLastChance,
-    GameStateGameOver,
-} GameState;
+    NotificationApp* notification;
+    uint32_t last_tick[2]; // per SnakeFeedback, when it was last played
+    bool played[2];
+    uint32_t sent;
+    uint32_t coalesced; // dropped by the rate limit
+} SnakeNotifier;
+
+// When a queued turn was pressed, to time it until the snake takes it
+typedef struct {
+    bool timed; // false for a turn that came with a loaded game
+    uint32_t tick;
+    uint32_t step;
+} SnakeTurnStamp;
 
+// Pages of the debug overlay, long Ok flips through them
 typedef enum {
-    DirectionUp,
-    DirectionRight,
-    DirectionDown,
-    DirectionLeft,
-} Direction;
-
-#define MAX_SNAKE_LEN 15 * 31 //128 * 64 / 4 - 1px border line
-
-#define x_back_symbol 50
-#define y_back_symbol 9
-
-#define x_arrow_left 81
-#define y_arrow_left 20
-
-#define x_arrow_right 104
-#define y_arrow_right 20
-
-#define SAVING_FILENAME APP_DATA_PATH("snake2.save")
+    SnakeDebugPageOff,
+    SnakeDebugPageInput, // turn latency and dropped events
+#ifdef SNAKE_PROFILE
+    SnakeDebugPageProfile, // hot path timings, opening it also writes them to a file
+#endif
+    SnakeDebugPageCount,
+} SnakeDebugPage;
+
+// The profile page changes with every frame drawn, it is redrawn only this often
+#define DEBUG_PROFILE_REFRESH_MS 1000
+#define PROFILE_REPORT_SIZE 1536
+
+// How fast the game answers the keys, shown on the debug overlay
+typedef struct {
+    SnakeTurnStamp stamps[SNAKE_TURN_QUEUE_LEN + 1]; // nextMovement and the queue
+    uint8_t stamp_count;
+    uint32_t turns_dropped; // the turn queue was full
+    atomic_uint ticks_dropped; // the event queue was full, written by the timer
+    uint32_t ticks_dropped_shown;
+    uint32_t turns_taken;
+    uint32_t latency_steps; // of the last turn taken
+    uint32_t latency_ms;
+    uint32_t latency_max_ms;
+    uint64_t latency_sum_ms;
+    bool changed;
+} SnakeInputStats;
 
 typedef struct {
-    FuriMutex* mutex;
-    Point points[MAX_SNAKE_LEN];
-    uint16_t len;
-    Direction currentMovement;
-    Direction nextMovement; // if backward of currentMovement, ignore
-    Point fruit;
-    GameState state;
-    bool Endlessmode;
-    uint32_t timer_start_timestamp;
-    uint32_t timer_stopped_seconds;
-} SnakeState;
+    SnakeState game; // touched by the game loop only
+    SnakeFrame frame; // what the game loop publishes
+    SnakeFrameLatch latch;
+    SnakeFrame render_frame; // the GUI thread's private copy
+    uint32_t frames_drawn; // loop iterations that published a new frame
+    uint32_t frames_skipped; // loop iterations that left the screen alone
+    SnakeSaver* saver;
+    uint32_t autosave_tick;
+    SnakeJournal journal; // its buffer also holds the file while replaying
+    bool recording;
+    bool playing; // a game of the player's or the autopilot's, logged when it's left
+    SnakeReplay replay;
+    bool replaying;
+    SnakeRewind rewind; // the steps of the player's game, Up steps back through them
+    SnakeAutopilot pilot;
+    bool piloting; // the autopilot plays, at boost speed
+    // Allocated while the arena is played, the classic game waits at game over meanwhile
+    SnakeArena* arena;
+    SnakeScheduler scheduler; // decides on which base tick the snake moves
+    FuriMessageQueue* event_queue;
+    SnakeInputStats input;
+    SnakeNotifier notifier;
+    bool idle; // paused or game over: no timer, the loop sleeps until a key comes
+    uint32_t idle_tick; // last key press while idle
+    bool backlight_enforced;
+    SnakeDebugPage debug_page;
+    uint32_t debug_tick; // when the profile page was last formatted
+#ifdef SNAKE_PROFILE
+    char profile_report[PROFILE_REPORT_SIZE];
+#endif
+} SnakeApp;
 
 typedef enum {
     EventTypeTick,
@@ -65,6 +122,7 @@ typedef enum {
 typedef struct {
     EventType type;
     InputEvent input;
+    uint32_t tick; // when the event was sent
 } SnakeEvent;
 
 const NotificationSequence sequence_fail = {
@@ -101,522 +159,682 @@ const NotificationSequence sequence_eat = {
 
 static void snake_game_render_callback(Canvas* const canvas, void* ctx) {
     furi_assert(ctx);
-    const SnakeState* snake_state = ctx;
-    furi_mutex_acquire(snake_state->mutex, FuriWaitForever);
-
-    // Before the function is called, the state is set with the canvas_reset(canvas)
-
-    // Frame
-    canvas_draw_frame(canvas, 0, 0, 128, 64);
-    
-    // Fruit
-    Point f = snake_state->fruit;
-    f.x = f.x * 4 + 1;
-    f.y = f.y * 4 + 1;
-    canvas_draw_rframe(canvas, f.x, f.y, 6, 6, 2);
-    canvas_draw_dot(canvas, f.x + 3, f.y - 1);
-    canvas_draw_dot(canvas, f.x + 4, f.y - 2);
-
-    //Dot in the middle of an apple (just to know if the Endless mode is turn off)
-    if(!snake_state->Endlessmode) {
-        canvas_draw_dot(canvas, f.x + 2, f.y + 2);
-        canvas_draw_dot(canvas, f.x + 2, f.y + 3);
-        canvas_draw_dot(canvas, f.x + 3, f.y + 2);
-        canvas_draw_dot(canvas, f.x + 3, f.y + 3);
-    }
-
-    // Snake
-    for(uint16_t i = 0; i < snake_state->len; i++) {
-        Point p = snake_state->points[i];
-        p.x = p.x * 4 + 2;
-        p.y = p.y * 4 + 2;
-        canvas_draw_box(canvas, p.x, p.y, 4, 4);
-        if(i == 0) {
-            canvas_set_color(canvas, ColorWhite);
-            canvas_draw_box(canvas, p.x + 1, p.y + 1, 2, 2);
-            canvas_set_color(canvas, ColorBlack);
-        }
-    }
-
-    // Pause and GameOver banner
-    if(snake_state->state == GameStatePause || snake_state->state == GameStateGameOver) {
-        // Screen is 128x64 px
-        canvas_set_color(canvas, ColorWhite);
-        canvas_draw_box(canvas, 33, 23, 64, 26);
-
-        canvas_set_color(canvas, ColorBlack);
-        canvas_draw_frame(canvas, 34, 24, 62, 24);
-
-        canvas_set_font(canvas, FontPrimary);
-        if(snake_state->state == GameStateGameOver) {
-            if(snake_state->len >= MAX_SNAKE_LEN-1) {
-                canvas_draw_str_aligned(canvas, 65, 35, AlignCenter, AlignBottom, "You WON!");
-            } else {
-                canvas_draw_str_aligned(canvas, 65, 35, AlignCenter, AlignBottom, "Game Over");
-            }
-        }
-        if(snake_state->state == GameStatePause) {
-            canvas_draw_str_aligned(canvas, 65, 35, AlignCenter, AlignBottom, "Pause");
-        }
-
-        canvas_set_font(canvas, FontSecondary);
-        char buffer[40];
-        snprintf(buffer, sizeof(buffer), "Score: %u", snake_state->len - 7U);
-        canvas_draw_str_aligned(canvas, 65, 45, AlignCenter, AlignBottom, buffer);
-
-        // Painting "back"-symbol, Help message for Exit App, ProgressBar (Complete %)
-        canvas_set_color(canvas, ColorWhite);
-        canvas_draw_box(canvas, 22, 1, 87, 22);
-        canvas_draw_box(canvas, 24, 54, 83, 9);
-        canvas_set_color(canvas, ColorBlack);
-        canvas_draw_str_aligned(
-            canvas, 65, 10, AlignCenter, AlignBottom, "Hold        to Exit App");
-        //Endless mode ON/OFF
-        if(snake_state->Endlessmode == false) {
-            canvas_draw_str_aligned(canvas, 24, 21, AlignLeft, AlignBottom, "Endless mode   OFF");
-        } else {
-            canvas_draw_str_aligned(canvas, 24, 21, AlignLeft, AlignBottom, "Endless mode");
-            canvas_draw_str_aligned(canvas, 89, 21, AlignLeft, AlignBottom, "ON");
-        }
-
-        snprintf(
-            buffer,
-            sizeof(buffer),
-            "%-5.1f%% (%.2ld:%.2ld:%.2ld)",
-            (double)((snake_state->len - 7U) / 4.57),
-            snake_state->timer_stopped_seconds / 60 / 60,
-            snake_state->timer_stopped_seconds / 60 % 60,
-            snake_state->timer_stopped_seconds % 60);
-
-        //Back symbol
-        {
-            canvas_draw_dot(canvas, x_back_symbol + 0, y_back_symbol);
-            canvas_draw_dot(canvas, x_back_symbol + 1, y_back_symbol);
-            canvas_draw_dot(canvas, x_back_symbol + 2, y_back_symbol);
-            canvas_draw_dot(canvas, x_back_symbol + 3, y_back_symbol);
-            canvas_draw_dot(canvas, x_back_symbol + 4, y_back_symbol);
-            canvas_draw_dot(canvas, x_back_symbol + 5, y_back_symbol - 1);
-            canvas_draw_dot(canvas, x_back_symbol + 6, y_back_symbol - 2);
-            canvas_draw_dot(canvas, x_back_symbol + 6, y_back_symbol - 3);
-            canvas_draw_dot(canvas, x_back_symbol + 5, y_back_symbol - 4);
-            canvas_draw_dot(canvas, x_back_symbol + 4, y_back_symbol - 5);
-            canvas_draw_dot(canvas, x_back_symbol + 3, y_back_symbol - 5);
-            canvas_draw_dot(canvas, x_back_symbol + 2, y_back_symbol - 5);
-            canvas_draw_dot(canvas, x_back_symbol + 1, y_back_symbol - 5);
-            canvas_draw_dot(canvas, x_back_symbol + 0, y_back_symbol - 5);
-            canvas_draw_dot(canvas, x_back_symbol - 1, y_back_symbol - 5);
-            canvas_draw_dot(canvas, x_back_symbol - 2, y_back_symbol - 5);
-            canvas_draw_dot(canvas, x_back_symbol - 3, y_back_symbol - 5);
-            canvas_draw_dot(canvas, x_back_symbol - 2, y_back_symbol - 6);
-            canvas_draw_dot(canvas, x_back_symbol - 2, y_back_symbol - 4);
-            canvas_draw_dot(canvas, x_back_symbol - 1, y_back_symbol - 6);
-            canvas_draw_dot(canvas, x_back_symbol - 1, y_back_symbol - 4);
-            canvas_draw_dot(canvas, x_back_symbol - 1, y_back_symbol - 7);
-            canvas_draw_dot(canvas, x_back_symbol - 1, y_back_symbol - 3);
-        }
-        //Left Arrow
-        canvas_draw_str_aligned(canvas, 65, 62, AlignCenter, AlignBottom, buffer);
-        {
-            canvas_draw_dot(canvas, x_arrow_left + 0, y_arrow_left - 3);
-            canvas_draw_dot(canvas, x_arrow_left + 1, y_arrow_left - 2);
-            canvas_draw_dot(canvas, x_arrow_left + 1, y_arrow_left - 3);
-            canvas_draw_dot(canvas, x_arrow_left + 1, y_arrow_left - 4);
-            canvas_draw_dot(canvas, x_arrow_left + 2, y_arrow_left - 1);
-            canvas_draw_dot(canvas, x_arrow_left + 2, y_arrow_left - 2);
-            canvas_draw_dot(canvas, x_arrow_left + 2, y_arrow_left - 3);
-            canvas_draw_dot(canvas, x_arrow_left + 2, y_arrow_left - 4);
-            canvas_draw_dot(canvas, x_arrow_left + 2, y_arrow_left - 5);
-            canvas_draw_dot(canvas, x_arrow_left + 3, y_arrow_left - 0);
-            canvas_draw_dot(canvas, x_arrow_left + 3, y_arrow_left - 1);
-            canvas_draw_dot(canvas, x_arrow_left + 3, y_arrow_left - 2);
-            canvas_draw_dot(canvas, x_arrow_left + 3, y_arrow_left - 3);
-            canvas_draw_dot(canvas, x_arrow_left + 3, y_arrow_left - 4);
-            canvas_draw_dot(canvas, x_arrow_left + 3, y_arrow_left - 5);
-            canvas_draw_dot(canvas, x_arrow_left + 3, y_arrow_left - 6);
-        }
+    SnakeApp* snake_app = ctx;
 
-        //Right Arrow
-        canvas_draw_str_aligned(canvas, 65, 62, AlignCenter, AlignBottom, buffer);
-        {
-            canvas_draw_dot(canvas, x_arrow_right + 0, y_arrow_right - 0);
-            canvas_draw_dot(canvas, x_arrow_right + 0, y_arrow_right - 1);
-            canvas_draw_dot(canvas, x_arrow_right + 0, y_arrow_right - 2);
-            canvas_draw_dot(canvas, x_arrow_right + 0, y_arrow_right - 3);
-            canvas_draw_dot(canvas, x_arrow_right + 0, y_arrow_right - 4);
-            canvas_draw_dot(canvas, x_arrow_right + 0, y_arrow_right - 5);
-            canvas_draw_dot(canvas, x_arrow_right + 0, y_arrow_right - 6);
-            canvas_draw_dot(canvas, x_arrow_right + 1, y_arrow_right - 1);
-            canvas_draw_dot(canvas, x_arrow_right + 1, y_arrow_right - 2);
-            canvas_draw_dot(canvas, x_arrow_right + 1, y_arrow_right - 3);
-            canvas_draw_dot(canvas, x_arrow_right + 1, y_arrow_right - 4);
-            canvas_draw_dot(canvas, x_arrow_right + 1, y_arrow_right - 5);
-            canvas_draw_dot(canvas, x_arrow_right + 2, y_arrow_right - 2);
-            canvas_draw_dot(canvas, x_arrow_right + 2, y_arrow_right - 3);
-            canvas_draw_dot(canvas, x_arrow_right + 2, y_arrow_right - 4);
-            canvas_draw_dot(canvas, x_arrow_right + 3, y_arrow_right - 3);
-        }
-    }
-
-    furi_mutex_release(snake_state->mutex);
-}
-
-bool load_game(SnakeState* snake_state) {
-    Storage* storage = furi_record_open(RECORD_STORAGE);
-
-    File* file = storage_file_alloc(storage);
-    uint16_t bytes_readed = 0;
-    if(storage_file_open(file, SAVING_FILENAME, FSAM_READ, FSOM_OPEN_EXISTING)) {
-        bytes_readed = storage_file_read(file, snake_state, sizeof(SnakeState));
-    }
-    storage_file_close(file);
-    storage_file_free(file);
-
-    furi_record_close(RECORD_STORAGE);
-
-    return bytes_readed == sizeof(SnakeState);
-}
-
-void save_game(const SnakeState* snake_state) {
-    Storage* storage = furi_record_open(RECORD_STORAGE);
-
-    File* file = storage_file_alloc(storage);
-    if(storage_file_open(file, SAVING_FILENAME, FSAM_WRITE, FSOM_CREATE_ALWAYS)) {
-        storage_file_write(file, snake_state, sizeof(SnakeState));
-    }
-    storage_file_close(file);
-    storage_file_free(file);
-
-    furi_record_close(RECORD_STORAGE);
+    SNAKE_PROFILE_BEGIN(SnakeProfileRender);
+    // Never blocks the game loop, see SnakeFrameLatch
+    snake_frame_read(&snake_app->latch, &snake_app->render_frame);
+    snake_game_render(canvas, &snake_app->render_frame);
+    SNAKE_PROFILE_END(SnakeProfileRender);
 }
 
 static void snake_game_input_callback(InputEvent* input_event, void* ctx) {
     furi_assert(ctx);
     FuriMessageQueue* event_queue = ctx;
 
-    SnakeEvent event = {.type = EventTypeKey, .input = *input_event};
+    SnakeEvent event = {.type = EventTypeKey, .input = *input_event, .tick = furi_get_tick()};
     furi_message_queue_put(event_queue, &event, FuriWaitForever);
 }
 
 static void snake_game_update_timer_callback(void* ctx) {
     furi_assert(ctx);
-    FuriMessageQueue* event_queue = ctx;
+    SnakeApp* snake_app = ctx;
 
-    SnakeEvent event = {.type = EventTypeTick};
-    furi_message_queue_put(event_queue, &event, 0);
+    // A lost tick only delays the next step, the scheduler goes by the clock
+    SnakeEvent event = {.type = EventTypeTick, .tick = furi_get_tick()};
+    if(furi_message_queue_put(snake_app->event_queue, &event, 0) != FuriStatusOk) {
+        atomic_fetch_add_explicit(&snake_app->input.ticks_dropped, 1, memory_order_relaxed);
+    }
 }
 
-static void snake_game_init_game(SnakeState* const snake_state) {
-    Point p[] = {{8, 6}, {7, 6}, {6, 6}, {5, 6}, {4, 6}, {3, 6}, {2, 6}};
-    memcpy(snake_state->points, p, sizeof(p)); //-V1086
-
-    snake_state->len = 7;
+static uint32_t snake_20_ticks_to_ms(uint32_t ticks) {
+    return (uint64_t)ticks * 1000 / furi_kernel_get_tick_frequency();
+}
 
-    snake_state->currentMovement = DirectionRight;
+static uint32_t snake_20_get_ms(void* ctx) {
+    UNUSED(ctx);
+    // The kernel tick is monotonic and cheap, unlike the RTC
+    return snake_20_ticks_to_ms(furi_get_tick());
+}
 
-    snake_state->nextMovement = DirectionRight;
+static uint32_t snake_20_random(void* ctx) {
+    UNUSED(ctx);
+    // Only seeds new games, the game draws from its own generator after that
+    return furi_hal_random_get();
+}
 
-    Point f = {18, 6};
-    snake_state->fruit = f;
+static void snake_20_feedback(void* ctx, SnakeFeedback feedback) {
+    SnakeNotifier* notifier = ctx;
+    uint32_t period_ms = feedback == SnakeFeedbackFail ? FEEDBACK_FAIL_PERIOD_MS :
+                                                         FEEDBACK_EAT_PERIOD_MS;
+    uint32_t now = furi_get_tick();
+    if(notifier->played[feedback] &&
+       now - notifier->last_tick[feedback] < furi_ms_to_ticks(period_ms)) {
+        notifier->coalesced++;
+        return;
+    }
+    notifier->played[feedback] = true;
+    notifier->last_tick[feedback] = now;
+    notifier->sent++;
+
+    // Only queued here, the game loop never waits for a sequence to finish
+    switch(feedback) {
+    case SnakeFeedbackFail:
+        notification_message(notifier->notification, &sequence_fail);
+        break;
+    case SnakeFeedbackEat:
+        notification_message(notifier->notification, &sequence_eat);
+        notification_message(notifier->notification, &sequence_blink_red_100);
+        break;
+    }
+}
 
-    DateTime curr_dt;
-    furi_hal_rtc_get_datetime(&curr_dt);
-    uint32_t curr_ts = datetime_datetime_to_timestamp(&curr_dt);
+// The turn queue of the game starts over: new game, load or replay
+static void snake_20_clear_turns(SnakeApp* const snake_app) {
+    SnakeInputStats* input = &snake_app->input;
+    input->stamp_count = 0;
+    if(snake_game_get_turn_snake(&snake_app->game) != snake_app->game.currentMovement) {
+        // A save can hold a pending nextMovement, nobody pressed it in this session
+        input->stamps[input->stamp_count++] = (SnakeTurnStamp){.timed = false};
+    }
+}
 
-    snake_state->timer_stopped_seconds = 0;
-    snake_state->timer_start_timestamp = curr_ts;
+// A direction key while the game runs, journaled only if the snake will take it
+static void snake_20_turn(SnakeApp* const snake_app, Direction direction, uint32_t tick) {
+    SnakeInputStats* input = &snake_app->input;
+    switch(snake_game_queue_turn(&snake_app->game, direction)) {
+    case SnakeTurnQueued:
+        input->stamps[input->stamp_count++] =
+            (SnakeTurnStamp){.timed = true, .tick = tick, .step = snake_app->game.steps};
+        if(snake_app->recording) {
+            snake_journal_record(
+                &snake_app->journal, &snake_app->game, (SnakeJournalEvent)direction);
+        }
+        break;
+    case SnakeTurnDropped:
+        input->turns_dropped++;
+        input->changed = true;
+        break;
+    case SnakeTurnIgnored:
+        break;
+    }
+}
 
-    snake_state->state = GameStateLife;
+// After a step: times the turn the snake just took from the key press
+static void snake_20_turn_taken(SnakeApp* const snake_app) {
+    SnakeInputStats* input = &snake_app->input;
+    if(!snake_app->game.changes.turned || !input->stamp_count) {
+        return;
+    }
+    SnakeTurnStamp stamp = input->stamps[0];
+    input->stamp_count--;
+    memmove(input->stamps, input->stamps + 1, input->stamp_count * sizeof(SnakeTurnStamp));
+    if(!stamp.timed) {
+        return;
+    }
 
-    save_game(snake_state);
+    input->latency_steps = snake_app->game.steps - stamp.step;
+    input->latency_ms = snake_20_ticks_to_ms(furi_get_tick() - stamp.tick);
+    if(input->latency_ms > input->latency_max_ms) {
+        input->latency_max_ms = input->latency_ms;
+    }
+    input->latency_sum_ms += input->latency_ms;
+    input->turns_taken++;
+    input->changed = true;
 }
 
-static Point snake_game_get_new_fruit(SnakeState const* const snake_state) {
-    // Max number of fruits on x axis = (16 * 2) - 1 = 31 (0<=x=>30)
-    // Max number of fruits on y axis = (8 * 2)  - 1 = 15 (0<=y=>14)
-    // Total fields for fruits and snake body = 31 * 15 = 465
-    // Empty fields for next random fruit = 465 - len(snake)
+static bool snake_20_debug_input(SnakeApp* const snake_app, SnakeDebugOverlay* const debug) {
+    SnakeInputStats* input = &snake_app->input;
+    uint32_t ticks_dropped = atomic_load_explicit(&input->ticks_dropped, memory_order_relaxed);
+    if(debug->lines && !input->changed && ticks_dropped == input->ticks_dropped_shown) {
+        return false;
+    }
+    input->changed = false;
+    input->ticks_dropped_shown = ticks_dropped;
+
+    debug->lines = 2;
+    snprintf(
+        debug->text[0],
+        sizeof(debug->text[0]),
+        "turn %lu st %lu ms, max %lu",
+        input->latency_steps,
+        input->latency_ms,
+        input->latency_max_ms);
+    snprintf(
+        debug->text[1],
+        sizeof(debug->text[1]),
+        "dropped turns %lu ticks %lu",
+        input->turns_dropped,
+        ticks_dropped);
+    return true;
+}
 
-    bool* all_fields;
-    int* empty_fields;
-    all_fields = (bool*)malloc(MAX_SNAKE_LEN * sizeof(bool));
-    empty_fields = (int*)malloc(MAX_SNAKE_LEN * sizeof(int));
+#ifdef SNAKE_PROFILE
+_Static_assert(SnakeProfilePhaseCount <= SNAKE_DEBUG_LINES, "a line per phase");
 
-    for(uint16_t j = 0; j < MAX_SNAKE_LEN; j++) {
-        all_fields[j] = false;
+static bool snake_20_debug_profile(SnakeApp* const snake_app, SnakeDebugOverlay* const debug) {
+    if(debug->lines &&
+       furi_get_tick() - snake_app->debug_tick < furi_ms_to_ticks(DEBUG_PROFILE_REFRESH_MS)) {
+        return false;
     }
+    snake_app->debug_tick = furi_get_tick();
 
-    for(uint16_t j = 0; j < snake_state->len; j++) {
-        Point p = snake_state->points[j];
-        all_fields[p.x + 31 * p.y] = true;
+    debug->lines = SnakeProfilePhaseCount;
+    for(uint8_t phase = 0; phase < SnakeProfilePhaseCount; phase++) {
+        snake_profile_format_line(phase, debug->text[phase], sizeof(debug->text[phase]));
     }
+    return true;
+}
 
-    int empty_counter = 0;
-    for(uint16_t j = 0; j < MAX_SNAKE_LEN; j++) {
-        if(!all_fields[j]) {
-            empty_fields[empty_counter] = j;
-            empty_counter++;
-        }
+// Writes every counter and histogram to snake2.profile.txt on the worker
+static void snake_20_dump_profile(SnakeApp* const snake_app) {
+    size_t size = snake_profile_format_report(snake_app->profile_report, PROFILE_REPORT_SIZE);
+    snake_saver_request_profile(snake_app->saver, snake_app->profile_report, size);
+}
+#endif
+
+// Refreshes the debug overlay text, returns true if it has to be redrawn
+static bool snake_20_debug_update(SnakeApp* const snake_app) {
+    SnakeDebugOverlay* debug = &snake_app->frame.debug;
+    switch(snake_app->debug_page) {
+    case SnakeDebugPageInput:
+        return snake_20_debug_input(snake_app, debug);
+#ifdef SNAKE_PROFILE
+    case SnakeDebugPageProfile:
+        return snake_20_debug_profile(snake_app, debug);
+#endif
+    default:
+        break;
     }
+    bool shown = debug->lines;
+    debug->lines = 0;
+    return shown;
+}
 
-    int newFruit = rand() % empty_counter;
+static void snake_20_record(SnakeApp* const snake_app) {
+    snake_journal_start(&snake_app->journal, &snake_app->game);
+    snake_app->recording = true;
+}
 
-    Point p = {
-        .x = empty_fields[newFruit] % 31,
-        .y = empty_fields[newFruit] / 31,
-    };
+// Logs the game when it is left for good: a new one starts, a replay takes its place or the
+// app exits. Not at game over, a rewind can take the game on from there.
+static void snake_20_log_game(SnakeApp* const snake_app, SnakePlatform const* const platform) {
+    if(!snake_app->playing) {
+        return;
+    }
+    snake_app->playing = false;
+    SnakeState* snake_state = &snake_app->game;
+    if(!snake_state->steps) {
+        // A level looked at and skipped
+        return;
+    }
+    uint32_t played_ms = snake_clock_read_ms(&snake_state->clock, platform->get_ms(platform->ctx));
+    uint32_t* speed_ticks = snake_app->scheduler.speed_ticks;
+    uint32_t running = speed_ticks[SnakeSpeedNormal] + speed_ticks[SnakeSpeedBoost] +
+                       speed_ticks[SnakeSpeedBrake];
+    FURI_LOG_I(
+        "SnakeGame",
+        "game: len %u, played %lu ms, %lu.%02lu steps/s, boosted %lu%%, braked %lu%%",
+        snake_state->len,
+        played_ms,
+        played_ms ? (uint32_t)((uint64_t)snake_state->steps * 1000 / played_ms) : 0,
+        played_ms ? (uint32_t)((uint64_t)snake_state->steps * 100000 / played_ms % 100) : 0,
+        running ? (uint32_t)((uint64_t)speed_ticks[SnakeSpeedBoost] * 100 / running) : 0,
+        running ? (uint32_t)((uint64_t)speed_ticks[SnakeSpeedBrake] * 100 / running) : 0);
+}
 
-    free(all_fields);
-    free(empty_fields);
+static void snake_20_new_game(
+    SnakeApp* const snake_app,
+    SnakePlatform const* const platform,
+    uint8_t level) {
+    snake_20_log_game(snake_app, platform);
+    snake_game_init_game(&snake_app->game, platform);
+    snake_game_load_level(&snake_app->game, level);
+    snake_scheduler_new_game(&snake_app->scheduler, furi_get_tick());
+    snake_20_clear_turns(snake_app);
+    snake_rewind_reset(&snake_app->rewind);
+    snake_playfield_draw(&snake_app->frame.playfield, &snake_app->game);
+    snake_saver_request(snake_app->saver, &snake_app->game);
+    snake_20_record(snake_app);
+    snake_app->playing = true;
+}
 
-    return p;
+// A new game on the next level, paused so the walls can be seen before it starts
+static void snake_20_next_level(SnakeApp* const snake_app, SnakePlatform const* const platform) {
+    uint8_t level = (snake_app->game.level + 1) % snake_level_count;
+    snake_20_new_game(snake_app, platform, level);
+    snake_game_timer_stop(&snake_app->game, platform);
+    snake_app->game.state = GameStatePause;
+    FURI_LOG_I("SnakeGame", "level %u: %s", level, snake_levels[level].name);
 }
 
-static bool snake_game_collision_with_frame(Point const next_step) {
-    // if x == 0 && currentMovement == left then x - 1 == 255 ,
-    // so check only x > right border
-    return next_step.x > 30 || next_step.y > 14;
+// Every other input that can change how the game goes comes through here and is journaled
+static void snake_20_input(
+    SnakeApp* const snake_app,
+    SnakeJournalEvent event,
+    SnakePlatform const* const platform) {
+    snake_journal_apply(&snake_app->game, event, platform);
+    if(snake_app->recording) {
+        snake_journal_record(&snake_app->journal, &snake_app->game, event);
+    }
 }
 
-static bool
-    snake_game_collision_with_tail(SnakeState const* const snake_state, Point const next_step) {
-    for(uint16_t i = 0; i < snake_state->len; i++) {
-        Point p = snake_state->points[i];
-        if(p.x == next_step.x && p.y == next_step.y) {
-            return true;
-        }
+// Writes the replay of the recording so far, at game over or when leaving the app
+static void snake_20_finish_recording(SnakeApp* const snake_app) {
+    if(!snake_app->recording) {
+        return;
     }
+    snake_app->recording = false;
+    size_t size = snake_journal_finish(&snake_app->journal, &snake_app->game);
+    snake_saver_request_replay(snake_app->saver, snake_app->journal.data, size);
+}
 
-    return false;
+// Takes the game back REWIND_STEPS steps, or as many as are kept, and pauses it there
+static bool snake_20_rewind(SnakeApp* const snake_app) {
+    if(!snake_app->rewind.step_count) {
+        return false;
+    }
+    // Kept in case the steps don't undo to a valid game, the stack is too small for it
+    SnakeState* backup = malloc(sizeof(SnakeState));
+    memcpy(backup, &snake_app->game, sizeof(SnakeState));
+    // Paused or over, the clock is stopped already
+    if(!snake_rewind_back(&snake_app->rewind, &snake_app->game, REWIND_STEPS)) {
+        memcpy(&snake_app->game, backup, sizeof(SnakeState));
+        free(backup);
+        FURI_LOG_W("SnakeGame", "rewind failed, the game stays where it was");
+        return false;
+    }
+    free(backup);
+    snake_20_clear_turns(snake_app);
+    snake_playfield_draw(&snake_app->frame.playfield, &snake_app->game);
+    // The recording can't go on past steps taken back, it starts over from here and is
+    // written at the next game over or exit. Like a new level, it starts from the running
+    // state and the game is paused after.
+    snake_20_record(snake_app);
+    snake_app->game.state = GameStatePause;
+    return true;
 }
 
-static Direction snake_game_get_turn_snake(SnakeState const* const snake_state) {
-    // Sum of two `Direction` lies between 0 and 6, odd values indicate orthogonality.
-    bool is_orthogonal = (snake_state->currentMovement + snake_state->nextMovement) % 2 == 1;
-    return is_orthogonal ? snake_state->nextMovement : snake_state->currentMovement;
+static bool snake_20_start_replay(SnakeApp* const snake_app, SnakePlatform const* const platform) {
+    // Replays aren't logged, the game they replace is
+    snake_20_log_game(snake_app, platform);
+    uint8_t* data = snake_app->journal.data;
+    size_t size = snake_saver_load_replay(data, sizeof(snake_app->journal.data));
+    if(!size || !snake_replay_start(&snake_app->replay, &snake_app->game, data, size)) {
+        FURI_LOG_W("SnakeGame", "no replay to play");
+        return false;
+    }
+    snake_game_timer_start(&snake_app->game, platform);
+    snake_scheduler_set_speed(&snake_app->scheduler, SnakeSpeedNormal);
+    snake_scheduler_new_game(&snake_app->scheduler, furi_get_tick());
+    snake_20_clear_turns(snake_app);
+    // The replayed game isn't stepped through the rewind, what it held is gone
+    snake_rewind_reset(&snake_app->rewind);
+    snake_playfield_draw(&snake_app->frame.playfield, &snake_app->game);
+    snake_app->replaying = true;
+    return true;
 }
 
-static Point snake_game_get_next_step(SnakeState const* const snake_state) {
-    Point next_step = snake_state->points[0];
-    switch(snake_state->currentMovement) {
-    // +-----x
-    // |
-    // |
-    // y
-    case DirectionUp:
-        next_step.y--;
-        break;
-    case DirectionRight:
-        next_step.x++;
-        break;
-    case DirectionDown:
-        next_step.y++;
-        break;
-    case DirectionLeft:
-        next_step.x--;
-        break;
+static void snake_20_stop_replay(SnakeApp* const snake_app, SnakePlatform const* const platform) {
+    snake_app->replaying = false;
+    // Whatever the recording ended with, the replayed game can't be continued
+    if(snake_app->game.state != GameStateGameOver) {
+        snake_game_timer_stop(&snake_app->game, platform);
+        snake_app->game.state = GameStateGameOver;
     }
-    return next_step;
 }
 
-static void snake_game_move_snake(SnakeState* const snake_state, Point const next_step) {
-    memmove(snake_state->points + 1, snake_state->points, snake_state->len * sizeof(Point));
-    snake_state->points[0] = next_step;
+// The autopilot's clock, the firmware enables the DWT cycle counter at boot
+static uint32_t snake_20_cycles(void) {
+    return DWT->CYCCNT;
 }
 
+// A new game played by the autopilot, until it ends or Back hands it to the player
 static void
-    snake_game_process_game_step(SnakeState* const snake_state, NotificationApp* notification) {
-    if(snake_state->state == GameStateGameOver) {
-        return;
+    snake_20_start_autopilot(SnakeApp* const snake_app, SnakePlatform const* const platform) {
+    // The pilot's cycle needs the plain board
+    snake_20_new_game(snake_app, platform, 0);
+    snake_autopilot_init(&snake_app->pilot);
+    // Searches are cut off by time, however many cells that is on this CPU
+    snake_app->pilot.now = snake_20_cycles;
+    snake_app->pilot.budget =
+        SNAKE_AUTOPILOT_BUDGET_US * furi_hal_cortex_instructions_per_microsecond();
+    snake_scheduler_set_speed(&snake_app->scheduler, SnakeSpeedBoost);
+    snake_app->piloting = true;
+}
+
+static void snake_20_stop_autopilot(SnakeApp* const snake_app) {
+    snake_app->piloting = false;
+    snake_scheduler_set_speed(&snake_app->scheduler, SnakeSpeedNormal);
+    SnakeAutopilot* pilot = &snake_app->pilot;
+    FURI_LOG_I(
+        "SnakeGame",
+        "autopilot: steps %lu, shortcuts %lu, paths found %lu, over budget %lu",
+        pilot->steps,
+        pilot->shortcuts,
+        pilot->searches,
+        pilot->overruns);
+}
+
+// The autopilot's turn goes into the journal like a key would
+static void snake_20_autopilot_turn(SnakeApp* const snake_app) {
+    Direction direction = snake_autopilot_steer(&snake_app->pilot, &snake_app->game);
+    if(snake_game_queue_turn(&snake_app->game, direction) == SnakeTurnQueued &&
+       snake_app->recording) {
+        snake_journal_record(&snake_app->journal, &snake_app->game, (SnakeJournalEvent)direction);
     }
+}
 
-    snake_state->currentMovement = snake_game_get_turn_snake(snake_state);
+// Holding the direction the snake moves in speeds it up, holding the opposite one brakes
+static void snake_20_hold(SnakeApp* const snake_app, Direction current, Direction direction) {
+    if(current == direction) {
+        snake_scheduler_set_speed(&snake_app->scheduler, SnakeSpeedBoost);
+    } else if((current + 2) % 4 == direction) {
+        snake_scheduler_set_speed(&snake_app->scheduler, SnakeSpeedBrake);
+    }
+}
 
-    Point next_step = snake_game_get_next_step(snake_state);
+static void
+    snake_20_arena_new_game(SnakeApp* const snake_app, SnakePlatform const* const platform) {
+    snake_arena_init(snake_app->arena, platform);
+    snake_scheduler_new_game(&snake_app->scheduler, furi_get_tick());
+    snake_playfield_draw_arena(&snake_app->frame.playfield, snake_app->arena);
+}
 
-    bool crush = snake_game_collision_with_frame(next_step);
-    if(crush) {
-        if(snake_state->state == GameStateLife) {
-            snake_state->state = GameStateLastChance;
-            return;
-        } else if(snake_state->state == GameStateLastChance) {
-            if(snake_state->Endlessmode) {
-                snake_state->state = GameStateLastChance;
-            } else {
-                DateTime curr_dt;
-                furi_hal_rtc_get_datetime(&curr_dt);
-                uint32_t curr_ts = datetime_datetime_to_timestamp(&curr_dt);
+static void snake_20_enter_arena(SnakeApp* const snake_app, SnakePlatform const* const platform) {
+    snake_app->arena = malloc(sizeof(SnakeArena));
+    snake_app->frame.overlay.valid = false;
+    snake_20_arena_new_game(snake_app, platform);
+}
 
-                snake_state->timer_stopped_seconds = curr_ts - snake_state->timer_start_timestamp;
+// Back to the classic game over screen, the arena game is dropped
+static void snake_20_leave_arena(SnakeApp* const snake_app) {
+    FURI_LOG_I(
+        "SnakeGame",
+        "arena: steps %lu, eaten %u, %s",
+        snake_app->arena->steps,
+        snake_app->arena->snakes[SNAKE_ARENA_PLAYER].eaten,
+        snake_app->arena->won ? "won" : "lost");
+    free(snake_app->arena);
+    snake_app->arena = NULL;
+    snake_app->frame.overlay.valid = false;
+    snake_scheduler_set_speed(&snake_app->scheduler, SnakeSpeedNormal);
+    snake_playfield_draw(&snake_app->frame.playfield, &snake_app->game);
+}
 
-                snake_state->state = GameStateGameOver;
-            }
-            notification_message_block(notification, &sequence_fail);
-            return;
+// A key in the arena, but the long Back that exits the app. Returns true if the playfield
+// was repainted.
+static bool snake_20_arena_key(
+    SnakeApp* const snake_app,
+    InputEvent const* const input,
+    SnakePlatform const* const platform) {
+    SnakeArena* arena = snake_app->arena;
+    if(input->type == InputTypeRelease) {
+        snake_scheduler_set_speed(&snake_app->scheduler, SnakeSpeedNormal);
+        return false;
+    }
+
+    Direction direction;
+    switch(input->key) {
+    case InputKeyUp:
+        direction = DirectionUp;
+        break;
+    case InputKeyDown:
+        direction = DirectionDown;
+        break;
+    case InputKeyRight:
+        direction = DirectionRight;
+        break;
+    case InputKeyLeft:
+        direction = DirectionLeft;
+        break;
+    case InputKeyOk:
+        if(input->type == InputTypePress && arena->state == GameStateGameOver) {
+            snake_20_arena_new_game(snake_app, platform);
+            return true;
         }
-    } else {
-        if(snake_state->state == GameStateLastChance) {
-            snake_state->state = GameStateLife;
+        if(input->type == InputTypePress && arena->state == GameStatePause) {
+            snake_clock_start(&arena->clock, platform->get_ms(platform->ctx));
+            arena->state = GameStateLife;
+        }
+        return false;
+    case InputKeyBack:
+        if(input->type == InputTypePress && arena->state == GameStateLife) {
+            arena->state = GameStatePause;
+            snake_clock_stop(&arena->clock, platform->get_ms(platform->ctx));
         }
+        return false;
+    default:
+        return false;
     }
 
-    crush = snake_game_collision_with_tail(snake_state, next_step);
-    if(crush) {
-        if(snake_state->Endlessmode) {
-            snake_state->state = GameStateLastChance;
-        } else {
-            DateTime curr_dt;
-            furi_hal_rtc_get_datetime(&curr_dt);
-            uint32_t curr_ts = datetime_datetime_to_timestamp(&curr_dt);
+    if(arena->state != GameStateLife) {
+        // After the crash a short Left or Right goes back to the classic game, like it
+        // switches Endless mode there. A paused arena game is never dropped.
+        if(arena->state == GameStateGameOver && input->type == InputTypeShort &&
+           (direction == DirectionLeft || direction == DirectionRight)) {
+            snake_20_leave_arena(snake_app);
+            return true;
+        }
+        return false;
+    }
+    if(input->type == InputTypePress || input->type == InputTypeLong) {
+        snake_arena_queue_turn(arena, direction);
+    }
+    if(input->type == InputTypeLong) {
+        snake_20_hold(snake_app, arena->snakes[SNAKE_ARENA_PLAYER].direction, direction);
+    }
+    return false;
+}
 
-            snake_state->timer_stopped_seconds = curr_ts - snake_state->timer_start_timestamp;
+// The state of whichever game is played, the arena or the classic one
+static GameState snake_20_state(SnakeApp const* const snake_app) {
+    return snake_app->arena ? snake_app->arena->state : snake_app->game.state;
+}
 
-            snake_state->state = GameStateGameOver;
-        }
-        notification_message_block(notification, &sequence_fail);
+static uint16_t snake_20_len(SnakeApp const* const snake_app) {
+    return snake_app->arena ? snake_app->arena->snakes[SNAKE_ARENA_PLAYER].len :
+                              snake_app->game.len;
+}
+
+// Stops the timer when the game stands still and starts it again when it goes on
+static void snake_20_update_idle(SnakeApp* const snake_app, FuriTimer* timer, uint32_t period) {
+    GameState state = snake_20_state(snake_app);
+    bool idle = !snake_app->replaying && (state == GameStatePause || state == GameStateGameOver);
+    if(idle == snake_app->idle) {
         return;
     }
-
-    bool eatFruit = (next_step.x == snake_state->fruit.x) && (next_step.y == snake_state->fruit.y);
-    if(eatFruit) {
-        snake_state->len++;
-        
-        if(snake_state->len >= MAX_SNAKE_LEN-1) {
-            //You win!!!
-            //It's impossible to collect ALL fruits, because
-            //the number of rows is odd (15),
-            //the number of columnss is odd too (31).
-            //You just can't locate the snake's body
-            //on the odd number of cells.
-            //Because of it you win when you collect
-            //all but one fruits.
-
-            DateTime curr_dt;
-            furi_hal_rtc_get_datetime(&curr_dt);
-            uint32_t curr_ts = datetime_datetime_to_timestamp(&curr_dt);
-
-            snake_state->timer_stopped_seconds = curr_ts - snake_state->timer_start_timestamp;
-
-            snake_state->state = GameStateGameOver;
-            notification_message_block(notification, &sequence_fail);
-            return;
-        }
+    snake_app->idle = idle;
+    if(idle) {
+        furi_timer_stop(timer);
+        snake_app->idle_tick = furi_get_tick();
+    } else {
+        snake_scheduler_reset(&snake_app->scheduler, furi_get_tick());
+        furi_timer_start(timer, period);
     }
+}
 
-    snake_game_move_snake(snake_state, next_step);
+// How long the loop may sleep: forever, unless the backlight is still to be released
+static uint32_t snake_20_idle_timeout(SnakeApp* const snake_app) {
+    if(!snake_app->idle || !snake_app->backlight_enforced) {
+        return FuriWaitForever;
+    }
+    uint32_t idle_ticks = furi_get_tick() - snake_app->idle_tick;
+    uint32_t limit = IDLE_BACKLIGHT_TIMEOUT_S * furi_kernel_get_tick_frequency();
+    return idle_ticks < limit ? limit - idle_ticks : 0;
+}
 
-    if(eatFruit) {
-        snake_state->fruit = snake_game_get_new_fruit(snake_state);
-        notification_message(notification, &sequence_eat);
-        notification_message(notification, &sequence_blink_red_100);
+static void snake_20_autosave(SnakeApp* const snake_app, SnakePlatform const* const platform) {
+    SnakeState* snake_state = &snake_app->game;
+    bool running =
+        snake_state->state == GameStateLife || snake_state->state == GameStateLastChance;
+    if(!running || !snake_state->Endlessmode ||
+       furi_get_tick() - snake_app->autosave_tick <
+           AUTOSAVE_PERIOD_S * furi_kernel_get_tick_frequency()) {
+        return;
     }
+    snake_app->autosave_tick = furi_get_tick();
+    // Brings the time played so far into the save, then the clock carries on
+    snake_game_timer_stop(snake_state, platform);
+    snake_saver_request(snake_app->saver, snake_state);
+    snake_game_timer_start(snake_state, platform);
 }
 
 int32_t snake_20_app(void* p) {
     UNUSED(p);
 
-    FuriMessageQueue* event_queue = furi_message_queue_alloc(8, sizeof(SnakeEvent));
+    // Deep enough for a burst of keys on top of the ticks that pile up meanwhile
+    FuriMessageQueue* event_queue = furi_message_queue_alloc(16, sizeof(SnakeEvent));
 
-    SnakeState* snake_state = malloc(sizeof(SnakeState));
-    if(!load_game(snake_state)) {
-        snake_game_init_game(snake_state);
-    } else {
-        DateTime curr_dt;
-        furi_hal_rtc_get_datetime(&curr_dt);
-        uint32_t curr_ts = datetime_datetime_to_timestamp(&curr_dt);
+    SnakePlatform platform = {
+        .get_ms = snake_20_get_ms,
+        .random = snake_20_random,
+        .feedback = snake_20_feedback,
+    };
 
-        snake_state->timer_start_timestamp = curr_ts - snake_state->timer_stopped_seconds;
+    SnakeApp* snake_app = malloc(sizeof(SnakeApp));
+    snake_app->frame.overlay.valid = false;
+    snake_app->frame.debug.lines = 0;
+    snake_app->debug_page = SnakeDebugPageOff;
+    snake_app->event_queue = event_queue;
+    memset(&snake_app->input, 0, sizeof(SnakeInputStats));
+    atomic_init(&snake_app->input.ticks_dropped, 0);
+    snake_app->frames_drawn = 0;
+    snake_app->frames_skipped = 0;
+    snake_app->saver = snake_saver_alloc();
+    snake_app->autosave_tick = furi_get_tick();
+    snake_app->recording = false;
+    snake_app->playing = false;
+    snake_app->replaying = false;
+    snake_app->piloting = false;
+    snake_app->arena = NULL;
+    snake_scheduler_init(&snake_app->scheduler, furi_kernel_get_tick_frequency());
+    SnakeState* snake_state = &snake_app->game;
+    if(!snake_saver_load(snake_state)) {
+        snake_20_new_game(snake_app, &platform, 0);
+    } else {
+        snake_game_timer_start(snake_state, &platform);
         snake_state->state = GameStateLife;
+        snake_scheduler_new_game(&snake_app->scheduler, furi_get_tick());
+        snake_20_clear_turns(snake_app);
+        snake_rewind_reset(&snake_app->rewind);
+        snake_playfield_draw(&snake_app->frame.playfield, snake_state);
+        // A resumed game is recorded from where it was resumed
+        snake_20_record(snake_app);
+        snake_app->playing = true;
     }
 
-    snake_state->mutex = furi_mutex_alloc(FuriMutexTypeNormal);
-    if(!snake_state->mutex) {
-        FURI_LOG_E("SnakeGame", "cannot create mutex\r\n");
-        furi_message_queue_free(event_queue);
-        free(snake_state);
-        return 255;
-    }
+    snake_frame_capture(&snake_app->frame, snake_state);
+    snake_frame_latch_init(&snake_app->latch, &snake_app->frame);
 
     ViewPort* view_port = view_port_alloc();
-    view_port_draw_callback_set(view_port, snake_game_render_callback, snake_state);
+    view_port_draw_callback_set(view_port, snake_game_render_callback, snake_app);
     view_port_input_callback_set(view_port, snake_game_input_callback, event_queue);
 
+    // Runs at the base rate whatever the speed, stopped only while idle
+    uint32_t base_period = furi_ms_to_ticks(SNAKE_SCHEDULER_BASE_MS);
     FuriTimer* timer =
-        furi_timer_alloc(snake_game_update_timer_callback, FuriTimerTypePeriodic, event_queue);
-    furi_timer_start(timer, furi_kernel_get_tick_frequency() / 4);
+        furi_timer_alloc(snake_game_update_timer_callback, FuriTimerTypePeriodic, snake_app);
+    snake_app->idle = true;
+    snake_20_update_idle(snake_app, timer, base_period);
 
     // Open GUI and register view_port
     Gui* gui = furi_record_open(RECORD_GUI);
     gui_add_view_port(gui, view_port, GuiLayerFullscreen);
     NotificationApp* notification = furi_record_open(RECORD_NOTIFICATION);
+    snake_app->notifier = (SnakeNotifier){.notification = notification};
+    platform.ctx = &snake_app->notifier;
 
     notification_message_block(notification, &sequence_display_backlight_enforce_on);
+    snake_app->backlight_enforced = true;
 
     dolphin_deed(DolphinDeedPluginGameStart);
 
     SnakeEvent event;
     for(bool processing = true; processing;) {
-        FuriStatus event_status = furi_message_queue_get(event_queue, &event, 100);
-
-        furi_mutex_acquire(snake_state->mutex, FuriWaitForever);
+        FuriStatus event_status =
+            furi_message_queue_get(event_queue, &event, snake_20_idle_timeout(snake_app));
+        // Set when the playfield was repainted, the rest is compared by snake_frame_capture
+        bool dirty = false;
+
+        if(event_status == FuriStatusOk && event.type == EventTypeKey) {
+            snake_app->idle_tick = event.tick;
+            if(!snake_app->backlight_enforced) {
+                // Back from idle, the key itself is handled as usual
+                notification_message(notification, &sequence_display_backlight_enforce_on);
+                snake_app->backlight_enforced = true;
+            }
+        }
 
+        SNAKE_PROFILE_BEGIN(SnakeProfileInput);
         if(event_status == FuriStatusOk) {
-            if(event.type == EventTypeKey) {
+            if(event.type == EventTypeKey && snake_app->replaying) {
+                // A replay only listens to Back, which ends it
+                if(event.input.type == InputTypePress && event.input.key == InputKeyBack) {
+                    snake_20_stop_replay(snake_app, &platform);
+                }
+            } else if(event.type == EventTypeKey && snake_app->piloting) {
+                // Back takes the game over from the autopilot, paused
+                if(event.input.type == InputTypePress && event.input.key == InputKeyBack) {
+                    snake_20_stop_autopilot(snake_app);
+                    if(snake_state->state == GameStateLife) {
+                        snake_state->state = GameStatePause;
+                        snake_game_timer_stop(snake_state, &platform);
+                    }
+                }
+            } else if(event.type == EventTypeKey && snake_app->arena) {
+                if(event.input.type == InputTypeLong && event.input.key == InputKeyBack &&
+                   snake_app->arena->state != GameStateLife) {
+                    // Exits like from the classic game, which is what gets saved
+                    snake_20_log_game(snake_app, &platform);
+                    snake_saver_request(snake_app->saver, snake_state);
+                    processing = false;
+                } else {
+                    dirty = snake_20_arena_key(snake_app, &event.input, &platform);
+                }
+            } else if(event.type == EventTypeKey) {
                 // press events
                 if(event.input.type == InputTypePress) {
                     switch(event.input.key) {
                     case InputKeyUp:
                         if(snake_state->state != GameStatePause) {
-                            snake_state->nextMovement = DirectionUp;
+                            snake_20_turn(snake_app, DirectionUp, event.tick);
                         }
                         break;
                     case InputKeyDown:
                         if(snake_state->state != GameStatePause) {
-                            snake_state->nextMovement = DirectionDown;
+                            snake_20_turn(snake_app, DirectionDown, event.tick);
                         }
                         break;
                     case InputKeyRight:
-                        if(snake_state->state == GameStatePause ||
-                           snake_state->state == GameStateGameOver) {
-                            snake_state->Endlessmode = !snake_state->Endlessmode;
-                        } else {
-                            snake_state->nextMovement = DirectionRight;
+                        // Paused or over it switches Endless mode on the short press below
+                        if(snake_state->state != GameStatePause &&
+                           snake_state->state != GameStateGameOver) {
+                            snake_20_turn(snake_app, DirectionRight, event.tick);
                         }
                         break;
                     case InputKeyLeft:
-                        if(snake_state->state == GameStatePause ||
-                           snake_state->state == GameStateGameOver) {
-                            snake_state->Endlessmode = !snake_state->Endlessmode;
-                        } else {
-                            snake_state->nextMovement = DirectionLeft;
+                        // Paused or over it switches Endless mode on the short press below
+                        if(snake_state->state != GameStatePause &&
+                           snake_state->state != GameStateGameOver) {
+                            snake_20_turn(snake_app, DirectionLeft, event.tick);
                         }
                         break;
                     case InputKeyOk:
                         if(snake_state->state == GameStateGameOver) {
-                            snake_game_init_game(snake_state);
+                            snake_20_new_game(snake_app, &platform, snake_state->level);
+                            dirty = true;
                         }
                         if(snake_state->state == GameStatePause) {
-                            DateTime curr_dt;
-                            furi_hal_rtc_get_datetime(&curr_dt);
-                            uint32_t curr_ts = datetime_datetime_to_timestamp(&curr_dt);
-
-                            snake_state->timer_start_timestamp =
-                                curr_ts - snake_state->timer_stopped_seconds;
-
-                            furi_timer_start(timer, furi_kernel_get_tick_frequency() / 4);
+                            snake_game_timer_start(snake_state, &platform);
                             snake_state->state = GameStateLife;
                         }
                         break;
                     case InputKeyBack:
                         if(snake_state->state == GameStateLife) {
-                            furi_timer_stop(timer);
                             snake_state->state = GameStatePause;
 
-                            DateTime curr_dt;
-                            furi_hal_rtc_get_datetime(&curr_dt);
-                            uint32_t curr_ts = datetime_datetime_to_timestamp(&curr_dt);
-
-                            snake_state->timer_stopped_seconds =
-                                curr_ts - snake_state->timer_start_timestamp;
+                            snake_game_timer_stop(snake_state, &platform);
 
                             break;
                         }
@@ -628,85 +846,158 @@ int32_t snake_20_app(void* p) {
                 if(event.input.type == InputTypeLong) {
                     switch(event.input.key) {
                     case InputKeyUp:
-                        if(snake_state->state != GameStatePause) {
-                            snake_state->nextMovement = DirectionUp;
-                            //Speed Up
-                            if(snake_state->currentMovement == DirectionUp) {
-                                furi_timer_start(timer, furi_kernel_get_tick_frequency() / 8);
-                            }
-                            //Breaking
-                            if(snake_state->currentMovement == DirectionDown) {
-                                furi_timer_start(timer, furi_kernel_get_tick_frequency() / 2);
-                            }
+                        if(snake_state->state == GameStateGameOver) {
+                            // Attract mode
+                            snake_20_start_autopilot(snake_app, &platform);
+                            dirty = true;
+                        } else if(snake_state->state != GameStatePause) {
+                            snake_20_turn(snake_app, DirectionUp, event.tick);
+                            snake_20_hold(snake_app, snake_state->currentMovement, DirectionUp);
                         }
                         break;
                     case InputKeyDown:
-                        if(snake_state->state != GameStatePause) {
-                            snake_state->nextMovement = DirectionDown;
-                            //Speed Up
-                            if(snake_state->currentMovement == DirectionDown) {
-                                furi_timer_start(timer, furi_kernel_get_tick_frequency() / 8);
-                            }
-                            //Breaking
-                            if(snake_state->currentMovement == DirectionUp) {
-                                furi_timer_start(timer, furi_kernel_get_tick_frequency() / 2);
+                        if(snake_state->state == GameStateGameOver) {
+                            // Plays the last recorded game back
+                            if(snake_20_start_replay(snake_app, &platform)) {
+                                dirty = true;
                             }
+                        } else if(snake_state->state != GameStatePause) {
+                            snake_20_turn(snake_app, DirectionDown, event.tick);
+                            snake_20_hold(snake_app, snake_state->currentMovement, DirectionDown);
                         }
                         break;
                     case InputKeyRight:
-                        if(snake_state->state != GameStatePause) {
-                            snake_state->nextMovement = DirectionRight;
-                            //Speed Up
-                            if(snake_state->currentMovement == DirectionRight) {
-                                furi_timer_start(timer, furi_kernel_get_tick_frequency() / 8);
-                            }
-                            //Breaking
-                            if(snake_state->currentMovement == DirectionLeft) {
-                                furi_timer_start(timer, furi_kernel_get_tick_frequency() / 2);
-                            }
+                        if(snake_state->state == GameStateGameOver) {
+                            snake_20_enter_arena(snake_app, &platform);
+                            dirty = true;
+                        } else if(snake_state->state != GameStatePause) {
+                            snake_20_turn(snake_app, DirectionRight, event.tick);
+                            snake_20_hold(snake_app, snake_state->currentMovement, DirectionRight);
                         }
                         break;
                     case InputKeyLeft:
                         if(snake_state->state != GameStatePause) {
-                            snake_state->nextMovement = DirectionLeft;
-                            //Speed Up
-                            if(snake_state->currentMovement == DirectionLeft) {
-                                furi_timer_start(timer, furi_kernel_get_tick_frequency() / 8);
-                            }
-                            //Breaking
-                            if(snake_state->currentMovement == DirectionRight) {
-                                furi_timer_start(timer, furi_kernel_get_tick_frequency() / 2);
-                            }
+                            snake_20_turn(snake_app, DirectionLeft, event.tick);
+                            snake_20_hold(snake_app, snake_state->currentMovement, DirectionLeft);
+                        }
+                        break;
+                    case InputKeyOk:
+                        snake_app->debug_page =
+                            (snake_app->debug_page + 1) % SnakeDebugPageCount;
+                        // The new page is formatted from scratch
+                        snake_app->frame.debug.lines = 0;
+#ifdef SNAKE_PROFILE
+                        if(snake_app->debug_page == SnakeDebugPageProfile) {
+                            snake_20_dump_profile(snake_app);
                         }
+#endif
+                        dirty = true;
                         break;
                     case InputKeyBack:
                         if(snake_state->state == GameStatePause ||
                            snake_state->state == GameStateGameOver) {
-                            save_game(snake_state);
+                            snake_20_finish_recording(snake_app);
+                            snake_20_log_game(snake_app, &platform);
+                            snake_saver_request(snake_app->saver, snake_state);
                             processing = false;
                         } else {
-                            snake_state->state = GameStateGameOver;
+                            snake_20_input(snake_app, SnakeJournalEventGiveUp, &platform);
                         }
                         break;
                     default:
                         break;
                     }
                 }
+                // A short Down, not the press a long one begins with, picks the level
+                if(event.input.type == InputTypeShort && event.input.key == InputKeyDown &&
+                   (snake_state->state == GameStateGameOver ||
+                    (snake_state->state == GameStatePause && !snake_state->steps))) {
+                    snake_20_next_level(snake_app, &platform);
+                    dirty = true;
+                }
+                // A short Up steps back about a second, paused or after the crash
+                if(event.input.type == InputTypeShort && event.input.key == InputKeyUp &&
+                   (snake_state->state == GameStatePause ||
+                    snake_state->state == GameStateGameOver)) {
+                    if(snake_20_rewind(snake_app)) {
+                        dirty = true;
+                    }
+                }
+                // A short Left or Right switches Endless mode, paused or over. Not on the
+                // press: a long Right after the crash is the arena, which doesn't have it.
+                if(event.input.type == InputTypeShort &&
+                   (event.input.key == InputKeyLeft || event.input.key == InputKeyRight) &&
+                   (snake_state->state == GameStatePause ||
+                    snake_state->state == GameStateGameOver)) {
+                    snake_20_input(snake_app, SnakeJournalEventEndless, &platform);
+                    // The apple shows the mode
+                    snake_playfield_draw(&snake_app->frame.playfield, snake_state);
+                    dirty = true;
+                }
                 //ReleaseKey Event
                 if(event.input.type == InputTypeRelease) {
-                    if(snake_state->state != GameStatePause) {
-                        furi_timer_start(timer, furi_kernel_get_tick_frequency() / 4);
-                    }
+                    snake_scheduler_set_speed(&snake_app->scheduler, SnakeSpeedNormal);
+                }
+            } else if(
+                event.type == EventTypeTick &&
+                (snake_app->idle ||
+                 !snake_scheduler_tick(
+                     &snake_app->scheduler,
+                     snake_20_state(snake_app),
+                     snake_20_len(snake_app),
+                     furi_get_tick()))) {
+                // Not time to move yet, or a tick sent before the timer was stopped
+            } else if(event.type == EventTypeTick && snake_app->arena) {
+                snake_arena_step(snake_app->arena, &platform);
+                dirty =
+                    snake_playfield_update_arena(&snake_app->frame.playfield, snake_app->arena);
+            } else if(event.type == EventTypeTick && snake_app->replaying) {
+                if(!snake_replay_step(&snake_app->replay, snake_state, &platform)) {
+                    snake_20_stop_replay(snake_app, &platform);
                 }
+                dirty = snake_playfield_update(&snake_app->frame.playfield, snake_state);
             } else if(event.type == EventTypeTick) {
-                snake_game_process_game_step(snake_state, notification);
+                if(snake_app->piloting) {
+                    snake_20_autopilot_turn(snake_app);
+                }
+                snake_rewind_step(&snake_app->rewind, snake_state, &platform);
+                snake_20_turn_taken(snake_app);
+                dirty = snake_playfield_update(&snake_app->frame.playfield, snake_state);
+                snake_20_autosave(snake_app, &platform);
+            }
+        } else if(snake_app->idle && snake_app->backlight_enforced) {
+            // Nobody has touched a key for a while, the screen may go dark
+            notification_message(notification, &sequence_display_backlight_enforce_auto);
+            snake_app->backlight_enforced = false;
+        }
+#ifdef SNAKE_PROFILE
+        if(event_status == FuriStatusOk && event.type == EventTypeKey) {
+            SNAKE_PROFILE_END(SnakeProfileInput);
+        }
+#endif
+
+        if(snake_state->state == GameStateGameOver) {
+            snake_20_finish_recording(snake_app);
+            if(snake_app->piloting) {
+                snake_20_stop_autopilot(snake_app);
             }
-        } else {
-            // event timeout
         }
 
-        furi_mutex_release(snake_state->mutex);
-        view_port_update(view_port);
+        snake_20_update_idle(snake_app, timer, base_period);
+
+        if(snake_app->arena) {
+            dirty |= snake_frame_capture_arena(&snake_app->frame, snake_app->arena);
+        } else {
+            dirty |= snake_frame_capture(&snake_app->frame, snake_state);
+        }
+        dirty |= snake_20_debug_update(snake_app);
+        if(dirty) {
+            snake_frame_publish(&snake_app->latch, &snake_app->frame);
+            view_port_update(view_port);
+            snake_app->frames_drawn++;
+        } else {
+            snake_app->frames_skipped++;
+        }
     }
 
     // Wait for all notifications to be played and return backlight to normal state
@@ -719,8 +1010,44 @@ int32_t snake_20_app(void* p) {
     furi_record_close(RECORD_NOTIFICATION);
     view_port_free(view_port);
     furi_message_queue_free(event_queue);
-    furi_mutex_free(snake_state->mutex);
-    free(snake_state);
+#ifdef SNAKE_PROFILE
+    snake_20_dump_profile(snake_app);
+#endif
+    // Waits for the last save to reach the card
+    snake_saver_free(snake_app->saver);
+    FURI_LOG_I(
+        "SnakeGame",
+        "frames drawn: %lu, skipped: %lu, read: %u, retried: %u",
+        snake_app->frames_drawn,
+        snake_app->frames_skipped,
+        atomic_load(&snake_app->latch.reads),
+        atomic_load(&snake_app->latch.retries));
+    SnakeScheduler* scheduler = &snake_app->scheduler;
+    FURI_LOG_I(
+        "SnakeGame",
+        "steps measured: %lu, jitter max: %lu ms, mean: %lu us",
+        scheduler->steps_measured,
+        scheduler->jitter_max * 1000 / scheduler->ticks_per_second,
+        scheduler->steps_measured ? (uint32_t)(scheduler->jitter_sum * 1000000 /
+                                               scheduler->ticks_per_second /
+                                               scheduler->steps_measured) :
+                                    0);
+    FURI_LOG_I(
+        "SnakeGame",
+        "feedback sent: %lu, coalesced: %lu",
+        snake_app->notifier.sent,
+        snake_app->notifier.coalesced);
+    SnakeInputStats* input = &snake_app->input;
+    FURI_LOG_I(
+        "SnakeGame",
+        "turns taken: %lu, latency max: %lu ms, mean: %lu ms, dropped turns: %lu, ticks: %u",
+        input->turns_taken,
+        input->latency_max_ms,
+        input->turns_taken ? (uint32_t)(input->latency_sum_ms / input->turns_taken) : 0,
+        input->turns_dropped,
+        atomic_load(&input->ticks_dropped));
+    free(snake_app->arena);
+    free(snake_app);
 
     return 0;
 }
@@ -0,0 +1,324 @@
+#include "snake_arena.h"
+
+#include <string.h>
+
+#include "snake_profile.h"
+
+_Static_assert(SNAKE_ARENA_SNAKES < 255, "owner is a byte");
+
+// A CPU snake now and then takes a random turn instead of the best one, one in this many
+#define SNAKE_ARENA_WANDER 8
+
+static uint32_t snake_arena_random(SnakeArena* const arena) {
+    return snake_game_xorshift(&arena->rng);
+}
+
+static void snake_arena_take(SnakeArena* const arena, Point const p) {
+    arena->row_free[p.y]--;
+    arena->free_count--;
+}
+
+static void snake_arena_give_back(SnakeArena* const arena, Point const p) {
+    arena->row_free[p.y]++;
+    arena->free_count++;
+}
+
+static inline bool snake_arena_same(Point const a, Point const b) {
+    return a.x == b.x && a.y == b.y;
+}
+
+static int8_t snake_arena_fruit_at(SnakeArena const* const arena, Point const p) {
+    for(uint8_t f = 0; f < SNAKE_ARENA_FRUITS; f++) {
+        if(snake_arena_same(arena->fruits[f], p)) {
+            return f;
+        }
+    }
+    return -1;
+}
+
+// A fruit only grows on a cell without a snake or another fruit, the n-th such cell in
+// reading order like in the classic game. With none free it waits off the board, and
+// every step tries again.
+static void snake_arena_spawn_fruit(SnakeArena* const arena, uint8_t f) {
+    if(!arena->free_count) {
+        arena->fruits[f] = (Point){.x = UINT8_MAX, .y = UINT8_MAX};
+        return;
+    }
+
+    uint16_t n = snake_arena_random(arena) % arena->free_count;
+    Point p = {.x = 0, .y = 0};
+    while(n >= arena->row_free[p.y]) {
+        n -= arena->row_free[p.y];
+        p.y++;
+    }
+    for(;; p.x++) {
+        if(!snake_arena_owner(arena, p) && snake_arena_fruit_at(arena, p) < 0) {
+            if(!n) {
+                break;
+            }
+            n--;
+        }
+    }
+    arena->fruits[f] = p;
+    snake_arena_take(arena, p);
+}
+
+static void snake_arena_changed(SnakeArena* const arena, Point const p) {
+    SnakeArenaChanges* changes = &arena->changes;
+    if(changes->count < SNAKE_ARENA_CHANGES) {
+        changes->cells[changes->count++] = p;
+    }
+}
+
+void snake_arena_init(SnakeArena* const arena, SnakePlatform const* const platform) {
+    memset(arena, 0, sizeof(SnakeArena));
+    memset(arena->row_free, SNAKE_BOARD_WIDTH, sizeof(arena->row_free));
+    arena->free_count = SNAKE_BOARD_CELLS;
+    // Off the board until spawned, so no cell looks taken by them
+    for(uint8_t f = 0; f < SNAKE_ARENA_FRUITS; f++) {
+        arena->fruits[f] = (Point){.x = UINT8_MAX, .y = UINT8_MAX};
+    }
+
+    // One row each, spread over the board, heading right and left in turn
+    for(uint8_t i = 0; i < SNAKE_ARENA_SNAKES; i++) {
+        SnakeArenaSnake* snake = &arena->snakes[i];
+        uint8_t y = (i + 1) * SNAKE_BOARD_HEIGHT / (SNAKE_ARENA_SNAKES + 1);
+        bool right = i % 2 == 0;
+        snake->direction = right ? DirectionRight : DirectionLeft;
+        snake->len = SNAKE_ARENA_START_LEN;
+        snake->alive = true;
+        for(uint16_t k = 0; k < SNAKE_ARENA_START_LEN; k++) {
+            uint8_t x = right ? SNAKE_ARENA_START_LEN + 1 - k :
+                                SNAKE_BOARD_WIDTH - SNAKE_ARENA_START_LEN - 2 + k;
+            Point p = {.x = x, .y = y};
+            snake->points[k] = p;
+            arena->owner[snake_game_cell(p)] = i + 1;
+            snake_arena_take(arena, p);
+        }
+    }
+
+    arena->rng = platform->random(platform->ctx);
+    if(!arena->rng) {
+        arena->rng = 1;
+    }
+    for(uint8_t f = 0; f < SNAKE_ARENA_FRUITS; f++) {
+        snake_arena_spawn_fruit(arena, f);
+    }
+
+    arena->state = GameStateLife;
+    snake_clock_reset(&arena->clock);
+    snake_clock_start(&arena->clock, platform->get_ms(platform->ctx));
+}
+
+Direction snake_arena_heading(SnakeArena const* const arena) {
+    SnakeArenaSnake const* player = &arena->snakes[SNAKE_ARENA_PLAYER];
+    return player->turn_count ? player->turns[player->turn_count - 1] : player->direction;
+}
+
+SnakeTurnResult snake_arena_queue_turn(SnakeArena* const arena, Direction direction) {
+    SnakeArenaSnake* player = &arena->snakes[SNAKE_ARENA_PLAYER];
+    if((snake_arena_heading(arena) + direction) % 2 == 0) {
+        return SnakeTurnIgnored;
+    }
+    if(player->turn_count == SNAKE_TURN_QUEUE_LEN + 1) {
+        return SnakeTurnDropped;
+    }
+    player->turns[player->turn_count++] = direction;
+    return SnakeTurnQueued;
+}
+
+uint8_t snake_arena_alive(SnakeArena const* const arena) {
+    uint8_t alive = 0;
+    for(uint8_t i = 0; i < SNAKE_ARENA_SNAKES; i++) {
+        alive += arena->snakes[i].alive;
+    }
+    return alive;
+}
+
+static bool snake_arena_is_open(SnakeArena const* const arena, Point const p) {
+    return !snake_game_collision_with_frame(p) && !snake_arena_owner(arena, p);
+}
+
+// Greedy CPU player: the open cell closest to a fruit, staying out of dead ends and away
+// from cells another head could take on the same step. Constant time per snake.
+static Direction snake_arena_cpu(SnakeArena* const arena, uint8_t index) {
+    SnakeArenaSnake const* snake = &arena->snakes[index];
+    Point head = snake->points[snake->head];
+    bool wander = snake_arena_random(arena) % SNAKE_ARENA_WANDER == 0;
+
+    Direction best = snake->direction;
+    uint32_t best_cost = UINT32_MAX;
+    for(uint8_t d = DirectionUp; d <= DirectionLeft; d++) {
+        if((d + 2) % 4 == (uint8_t)snake->direction) {
+            continue;
+        }
+        Point next = snake_game_neighbour(head, d);
+        if(!snake_arena_is_open(arena, next)) {
+            continue;
+        }
+
+        uint32_t cost = UINT16_MAX;
+        for(uint8_t f = 0; f < SNAKE_ARENA_FRUITS; f++) {
+            if(!snake_arena_has_fruit(arena, f)) {
+                continue;
+            }
+            Point fruit = arena->fruits[f];
+            uint32_t distance = (next.x > fruit.x ? next.x - fruit.x : fruit.x - next.x) +
+                                (next.y > fruit.y ? next.y - fruit.y : fruit.y - next.y);
+            if(distance < cost) {
+                cost = distance;
+            }
+        }
+        uint8_t exits = 0;
+        for(uint8_t e = DirectionUp; e <= DirectionLeft; e++) {
+            exits += snake_arena_is_open(arena, snake_game_neighbour(next, e));
+        }
+        if(!exits) {
+            cost += 1 << 20;
+        }
+        for(uint8_t i = 0; i < SNAKE_ARENA_SNAKES; i++) {
+            SnakeArenaSnake const* other = &arena->snakes[i];
+            if(i == index || !other->alive) {
+                continue;
+            }
+            Point o = other->points[other->head];
+            uint8_t dx = next.x > o.x ? next.x - o.x : o.x - next.x;
+            uint8_t dy = next.y > o.y ? next.y - o.y : o.y - next.y;
+            if(dx + dy == 1) {
+                cost += 1 << 16;
+            }
+        }
+        if(wander) {
+            cost = (cost & ~0xFFFFU) | (snake_arena_random(arena) & 0xFF);
+        }
+
+        if(cost < best_cost) {
+            best_cost = cost;
+            best = d;
+        }
+    }
+    return best;
+}
+
+static void snake_arena_remove(SnakeArena* const arena, uint8_t index) {
+    SnakeArenaSnake* snake = &arena->snakes[index];
+    uint16_t idx = snake->head;
+    for(uint16_t k = 0; k < snake->len; k++) {
+        arena->owner[snake_game_cell(snake->points[idx])] = 0;
+        snake_arena_give_back(arena, snake->points[idx]);
+        idx = idx + 1 == SNAKE_ARENA_MAX_LEN ? 0 : idx + 1;
+    }
+    snake->alive = false;
+    arena->changes.all = true;
+}
+
+static void snake_arena_move(SnakeArena* const arena, uint8_t index, Point const next) {
+    SnakeArenaSnake* snake = &arena->snakes[index];
+    int8_t fruit = snake_arena_fruit_at(arena, next);
+    bool grow = fruit >= 0 && snake->len < SNAKE_ARENA_MAX_LEN;
+
+    if(!grow) {
+        uint16_t tail = (snake->head + snake->len - 1) % SNAKE_ARENA_MAX_LEN;
+        arena->owner[snake_game_cell(snake->points[tail])] = 0;
+        snake_arena_give_back(arena, snake->points[tail]);
+        snake_arena_changed(arena, snake->points[tail]);
+    } else {
+        snake->len++;
+    }
+    // The old head loses its marker
+    snake_arena_changed(arena, snake->points[snake->head]);
+
+    snake->head = snake->head == 0 ? SNAKE_ARENA_MAX_LEN - 1 : snake->head - 1;
+    snake->points[snake->head] = next;
+    arena->owner[snake_game_cell(next)] = index + 1;
+    // A fruit's cell is already out of the free ones
+    if(fruit < 0) {
+        snake_arena_take(arena, next);
+    } else {
+        snake->eaten++;
+        arena->changes.fruits_moved |= 1 << fruit;
+        arena->changes.old_fruits[fruit] = next;
+    }
+    snake_arena_changed(arena, next);
+}
+
+static void snake_arena_finish(SnakeArena* const arena, SnakePlatform const* const platform) {
+    snake_clock_stop(&arena->clock, platform->get_ms(platform->ctx));
+    arena->state = GameStateGameOver;
+}
+
+void snake_arena_step(SnakeArena* const arena, SnakePlatform const* const platform) {
+    SNAKE_PROFILE_BEGIN(SnakeProfileStep);
+    memset(&arena->changes, 0, sizeof(arena->changes));
+    if(arena->state != GameStateLife) {
+        SNAKE_PROFILE_END(SnakeProfileStep);
+        return;
+    }
+    arena->steps++;
+
+    uint16_t eaten = arena->snakes[SNAKE_ARENA_PLAYER].eaten;
+
+    // Everybody decides on the board as it is
+    Point next[SNAKE_ARENA_SNAKES];
+    bool dies[SNAKE_ARENA_SNAKES];
+    for(uint8_t i = 0; i < SNAKE_ARENA_SNAKES; i++) {
+        SnakeArenaSnake* snake = &arena->snakes[i];
+        dies[i] = false;
+        if(!snake->alive) {
+            continue;
+        }
+        if(i == SNAKE_ARENA_PLAYER) {
+            if(snake->turn_count) {
+                snake->direction = snake->turns[0];
+                snake->turn_count--;
+                memmove(snake->turns, snake->turns + 1, snake->turn_count * sizeof(Direction));
+            }
+        } else {
+            snake->direction = snake_arena_cpu(arena, i);
+        }
+        next[i] = snake_game_neighbour(snake->points[snake->head], snake->direction);
+        dies[i] = !snake_arena_is_open(arena, next[i]);
+    }
+    for(uint8_t i = 0; i < SNAKE_ARENA_SNAKES; i++) {
+        for(uint8_t j = i + 1; j < SNAKE_ARENA_SNAKES; j++) {
+            if(arena->snakes[i].alive && arena->snakes[j].alive &&
+               snake_arena_same(next[i], next[j])) {
+                dies[i] = true;
+                dies[j] = true;
+            }
+        }
+    }
+
+    // The dead leave first, then the rest move in snake order
+    for(uint8_t i = 0; i < SNAKE_ARENA_SNAKES; i++) {
+        if(arena->snakes[i].alive && dies[i]) {
+            snake_arena_remove(arena, i);
+        }
+    }
+    for(uint8_t i = 0; i < SNAKE_ARENA_SNAKES; i++) {
+        if(arena->snakes[i].alive) {
+            snake_arena_move(arena, i, next[i]);
+        }
+    }
+    for(uint8_t f = 0; f < SNAKE_ARENA_FRUITS; f++) {
+        if(arena->changes.fruits_moved & (1 << f)) {
+            snake_arena_spawn_fruit(arena, f);
+        } else if(!snake_arena_has_fruit(arena, f) && arena->free_count) {
+            // Waited off the board for a free cell, old_fruits stays off it too
+            arena->changes.fruits_moved |= 1 << f;
+            arena->changes.old_fruits[f] = arena->fruits[f];
+            snake_arena_spawn_fruit(arena, f);
+        }
+    }
+
+    if(dies[SNAKE_ARENA_PLAYER]) {
+        snake_arena_finish(arena, platform);
+        platform->feedback(platform->ctx, SnakeFeedbackFail);
+    } else if(snake_arena_alive(arena) == 1) {
+        arena->won = true;
+        snake_arena_finish(arena, platform);
+    } else if(arena->snakes[SNAKE_ARENA_PLAYER].eaten != eaten) {
+        platform->feedback(platform->ctx, SnakeFeedbackEat);
+    }
+    SNAKE_PROFILE_END(SnakeProfileStep);
+}
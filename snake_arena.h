@@ -0,0 +1,81 @@
+#pragma once
+
+// Arena: the player's snake against CPU snakes, with several fruits on the board.
+//
+// Every snake moves in one batched step against a single grid that records which snake
+// is on each cell, so a step costs the same whatever the snakes' lengths. Moves are
+// judged against the board as it was before the step, tails included like in the classic
+// game: a head that runs into a wall or any body dies, and heads that meet on one cell
+// all die. Then the dead leave the board, the others move in snake order and eaten
+// fruits grow again in fruit order, all from the arena's own generator, so a seed always
+// plays out the same way.
+//
+// The game ends when the player dies, or is won when the player is the last one left.
+// Each snake grows up to an equal share of the board, after that fruits only count.
+
+#include "snake_game.h"
+
+#define SNAKE_ARENA_SNAKES 4 // snakes[0] is the player's, the others are CPU snakes
+#define SNAKE_ARENA_FRUITS 3
+#define SNAKE_ARENA_START_LEN 5
+#define SNAKE_ARENA_MAX_LEN (SNAKE_BOARD_CELLS / SNAKE_ARENA_SNAKES)
+#define SNAKE_ARENA_PLAYER 0
+
+// Cells one step can change: the new head, the old one and the tail of every snake
+#define SNAKE_ARENA_CHANGES (3 * SNAKE_ARENA_SNAKES)
+
+typedef struct {
+    Point points[SNAKE_ARENA_MAX_LEN]; // ring buffer, the head is at points[head]
+    uint16_t len;
+    uint16_t head;
+    Direction direction; // of the last step
+    Direction turns[SNAKE_TURN_QUEUE_LEN + 1]; // the player's, taken one per step
+    uint8_t turn_count;
+    bool alive;
+    uint16_t eaten;
+} SnakeArenaSnake;
+
+// What the last step changed, for the renderer
+typedef struct {
+    Point cells[SNAKE_ARENA_CHANGES];
+    uint8_t count;
+    uint8_t fruits_moved; // bit per fruit, old_fruits holds where it was
+    Point old_fruits[SNAKE_ARENA_FRUITS];
+    bool all; // a snake died, its whole body left the board
+} SnakeArenaChanges;
+
+typedef struct {
+    uint8_t owner[SNAKE_BOARD_CELLS]; // 0 for an empty cell, else the snake's index + 1
+    // Cells with neither a snake nor a fruit on them, per row and in all, for new fruits
+    // the way snake_game_get_new_fruit finds them
+    uint8_t row_free[SNAKE_BOARD_HEIGHT];
+    uint16_t free_count;
+    SnakeArenaSnake snakes[SNAKE_ARENA_SNAKES];
+    Point fruits[SNAKE_ARENA_FRUITS]; // off the board while no cell is free for one
+    GameState state;
+    bool won;
+    SnakeClock clock;
+    uint32_t rng; // xorshift32 state, never 0
+    uint32_t steps;
+    SnakeArenaChanges changes;
+} SnakeArena;
+
+void snake_arena_init(SnakeArena* const arena, SnakePlatform const* const platform);
+
+// Queues a turn of the player's snake, with the rules of snake_game_queue_turn
+SnakeTurnResult snake_arena_queue_turn(SnakeArena* const arena, Direction direction);
+
+// Where the player's snake will be heading after the turns already queued
+Direction snake_arena_heading(SnakeArena const* const arena);
+
+void snake_arena_step(SnakeArena* const arena, SnakePlatform const* const platform);
+
+uint8_t snake_arena_alive(SnakeArena const* const arena);
+
+static inline uint8_t snake_arena_owner(SnakeArena const* const arena, Point const p) {
+    return arena->owner[snake_game_cell(p)];
+}
+
+static inline bool snake_arena_has_fruit(SnakeArena const* const arena, uint8_t f) {
+    return !snake_game_collision_with_frame(arena->fruits[f]);
+}
@@ -0,0 +1,209 @@
+#include "snake_autopilot.h"
+
+#include <string.h>
+
+#include "snake_profile.h"
+
+_Static_assert(
+    SNAKE_BOARD_WIDTH % 2 && SNAKE_BOARD_HEIGHT % 2 && SNAKE_BOARD_HEIGHT >= 3,
+    "the cycle is laid out for odd board sides");
+
+#define SNAKE_AUTOPILOT_HEAD 0xFF // `first` of the cell the search starts from
+
+void snake_autopilot_init(SnakeAutopilot* const pilot) {
+    memset(pilot, 0, sizeof(SnakeAutopilot));
+}
+
+uint16_t snake_autopilot_position(Point const p) {
+    const uint16_t w = SNAKE_BOARD_WIDTH;
+    const uint16_t h = SNAKE_BOARD_HEIGHT;
+    if(p.y == 0) {
+        return p.x;
+    }
+    if(p.x == 0) {
+        // The way back up to (0, 0)
+        return SNAKE_AUTOPILOT_CYCLE_LEN - p.y;
+    }
+    if(p.y < h - 2) {
+        // Rows without their first cell, odd ones right to left
+        uint16_t row = w + (p.y - 1) * (w - 1);
+        return p.y % 2 ? row + (w - 1 - p.x) : row + (p.x - 1);
+    }
+
+    // The last two rows, down one column and up the next from right to left
+    uint16_t zigzag = w + (h - 3) * (w - 1);
+    if(p.x == w - 1) {
+        return p.y == h - 2 ? zigzag : zigzag + 1;
+    }
+    uint16_t column = w - 2 - p.x;
+    bool down = column % 2 == 0;
+    bool upper_first = (p.y == h - 2) == down;
+    return zigzag + 1 + 2 * column + (upper_first ? 0 : 1);
+}
+
+Direction snake_autopilot_cycle_direction(Point const p) {
+    const uint8_t w = SNAKE_BOARD_WIDTH;
+    const uint8_t h = SNAKE_BOARD_HEIGHT;
+    if(p.y == 0) {
+        return p.x < w - 1 ? DirectionRight : DirectionDown;
+    }
+    if(p.x == 0) {
+        return DirectionUp;
+    }
+    if(p.y < h - 2) {
+        if(p.y % 2) {
+            return p.x > 1 ? DirectionLeft : DirectionDown;
+        }
+        return p.x < w - 1 ? DirectionRight : DirectionDown;
+    }
+    if(p.x == w - 1) {
+        // Into the zigzag, from above the corner or from the corner itself
+        return DirectionLeft;
+    }
+    bool down = (w - 2 - p.x) % 2 == 0;
+    if(down) {
+        return p.y == h - 2 ? DirectionDown : DirectionLeft;
+    }
+    return p.y == h - 1 ? DirectionUp : DirectionLeft;
+}
+
+// How far along the cycle `to` is from `from`
+static inline uint16_t snake_autopilot_distance(uint16_t from, uint16_t to) {
+    return to >= from ? to - from : to + SNAKE_AUTOPILOT_CYCLE_LEN - from;
+}
+
+static inline bool snake_autopilot_neighbour(Point const p, Direction direction, Point* next) {
+    *next = p;
+    switch(direction) {
+    case DirectionUp:
+        next->y--;
+        break;
+    case DirectionRight:
+        next->x++;
+        break;
+    case DirectionDown:
+        next->y++;
+        break;
+    case DirectionLeft:
+        next->x--;
+        break;
+    }
+    return !snake_game_collision_with_frame(*next);
+}
+
+static inline bool snake_autopilot_is_fruit(SnakeState const* const snake_state, Point const p) {
+    return p.x == snake_state->fruit.x && p.y == snake_state->fruit.y;
+}
+
+// Breadth first search for the fruit over free cells that only go forward along the cycle
+// and no further than `limit` from the head. Sets `direction` to the first step of the
+// shortest such path.
+static bool snake_autopilot_search(
+    SnakeAutopilot* const pilot,
+    SnakeState const* const snake_state,
+    uint16_t from,
+    uint16_t limit,
+    Direction* direction) {
+    Point head = snake_state->head_point;
+    uint16_t head_cell = snake_game_cell(head);
+    memset(pilot->first, 0, sizeof(pilot->first));
+    pilot->first[head_cell] = SNAKE_AUTOPILOT_HEAD;
+    pilot->queue[0] = head_cell;
+
+    uint32_t start = pilot->now ? pilot->now() : 0;
+    uint16_t read = 0;
+    uint16_t write = 1;
+    while(read < write) {
+        bool over = pilot->now ?
+                        read % SNAKE_AUTOPILOT_CLOCK_EVERY == 0 &&
+                            pilot->now() - start > pilot->budget :
+                        read == SNAKE_AUTOPILOT_SEARCH_BUDGET;
+        if(over) {
+            pilot->overruns++;
+            return false;
+        }
+        uint16_t cell = pilot->queue[read++];
+        Point p = {.x = cell % SNAKE_BOARD_WIDTH, .y = cell / SNAKE_BOARD_WIDTH};
+        uint16_t distance =
+            cell == head_cell ? 0 : snake_autopilot_distance(from, snake_autopilot_position(p));
+
+        for(uint8_t d = DirectionUp; d <= DirectionLeft; d++) {
+            Point next;
+            if(!snake_autopilot_neighbour(p, d, &next)) {
+                continue;
+            }
+            uint16_t next_cell = snake_game_cell(next);
+            if(pilot->first[next_cell] || snake_game_is_occupied(snake_state, next)) {
+                continue;
+            }
+            uint16_t next_distance =
+                snake_autopilot_distance(from, snake_autopilot_position(next));
+            if(next_distance <= distance || next_distance > limit) {
+                continue;
+            }
+            pilot->first[next_cell] = cell == head_cell ? d + 1 : pilot->first[cell];
+            if(snake_autopilot_is_fruit(snake_state, next)) {
+                *direction = pilot->first[next_cell] - 1;
+                pilot->searches++;
+                return true;
+            }
+            pilot->queue[write++] = next_cell;
+        }
+    }
+    // The fruit is further along than the limit
+    return false;
+}
+
+Direction snake_autopilot_steer(SnakeAutopilot* const pilot, SnakeState const* const snake_state) {
+    SNAKE_PROFILE_BEGIN(SnakeProfilePilot);
+    Point head = snake_state->head_point;
+    Point tail = snake_state->tail_point;
+    uint16_t from = snake_autopilot_position(head);
+    uint16_t to_tail = snake_autopilot_distance(from, snake_autopilot_position(tail));
+    uint16_t to_fruit =
+        snake_autopilot_distance(from, snake_autopilot_position(snake_state->fruit));
+    if(!to_fruit) {
+        // Behind the head in the corner's place, a whole lap away
+        to_fruit = SNAKE_AUTOPILOT_CYCLE_LEN;
+    }
+
+    // How far along the cycle the next step may go, the next cell of it is always fine
+    uint16_t limit = 1;
+    if(snake_state->len < SNAKE_AUTOPILOT_SHORTCUT_LEN && to_tail > SNAKE_AUTOPILOT_SLACK + 1) {
+        limit = to_tail - SNAKE_AUTOPILOT_SLACK - 1;
+        if(limit > to_fruit) {
+            limit = to_fruit;
+        }
+    }
+
+    Direction direction = snake_autopilot_cycle_direction(head);
+    if(limit == 1 || !snake_autopilot_search(pilot, snake_state, from, limit, &direction)) {
+        // The longest step allowed, onto the fruit if two are as long
+        uint16_t best = 0;
+        for(uint8_t d = DirectionUp; d <= DirectionLeft; d++) {
+            Point next;
+            if(!snake_autopilot_neighbour(head, d, &next) ||
+               snake_game_is_occupied(snake_state, next)) {
+                continue;
+            }
+            uint16_t distance = snake_autopilot_distance(from, snake_autopilot_position(next));
+            if(!distance || distance > limit) {
+                continue;
+            }
+            if(distance > best ||
+               (distance == best && snake_autopilot_is_fruit(snake_state, next))) {
+                best = distance;
+                direction = d;
+            }
+        }
+    }
+
+    Point next;
+    snake_autopilot_neighbour(head, direction, &next);
+    if(snake_autopilot_distance(from, snake_autopilot_position(next)) > 1) {
+        pilot->shortcuts++;
+    }
+    pilot->steps++;
+    SNAKE_PROFILE_END(SnakeProfilePilot);
+    return direction;
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+// Autopilot: plays the game without a player, as an attract mode on the Flipper and as a
+// soak workload on the host that runs all the way to the win.
+//
+// The board has an odd number of cells, so no cycle visits all of them. The pilot's cycle
+// leaves one out: it runs along the top row, snakes down through the rows below, zigzags
+// through the last two rows and comes back up the left column. The bottom right corner
+// touches the cells before and after the one above its left neighbour, so either of the
+// two can take that place. That leaves SNAKE_AUTOPILOT_CYCLE_LEN positions, the length a
+// snake wins at. Positions are worked out from the coordinates, there is no table.
+//
+// The snake starts lying along the cycle, tail to head in order. Following the cycle keeps
+// it that way, and so does any step that moves the head further along without getting
+// close to the tail: the cells up to the tail are free, and the tail is always a walk
+// along the cycle away. Each step the pilot searches breadth first for the shortest such
+// path to the fruit and takes its first step. When the search runs out of its budget it
+// takes the longest allowed step towards the fruit instead, which costs nothing.
+//
+// The order only holds from the start of a game, so the pilot only takes over new games,
+// on the plain board: walls of a level would cut the cycle.
+
+#include "snake_game.h"
+
+#define SNAKE_AUTOPILOT_CYCLE_LEN (SNAKE_BOARD_CELLS - 1)
+
+// Cells one search may look at without a clock (see SnakeAutopilot.now). On the classic
+// board that is all of them, so the budget only bites on the big one. It keeps the host's
+// bot games the same on every machine.
+#define SNAKE_AUTOPILOT_SEARCH_BUDGET 512
+
+// Time one search may take with a clock, the FAP's budget. The game loop ticks every
+// SNAKE_SCHEDULER_BASE_MS (25 ms), a search is kept well under a tenth of that so the
+// step and the frame after it still fit. The cells looked at in that time are whatever
+// the CPU manages, the SnakeProfilePilot timings show how long steering takes in all.
+#define SNAKE_AUTOPILOT_BUDGET_US 2000
+
+// A search reads the clock once every this many cells
+#define SNAKE_AUTOPILOT_CLOCK_EVERY 32
+
+// Cycle positions kept free between the head and the tail when leaving the cycle. The tail
+// stays put for a step after every fruit.
+#define SNAKE_AUTOPILOT_SLACK 4
+
+// No more shortcuts from this length on, the snake just follows the cycle. The gaps that
+// shortcuts leave in the body take a while to close, a long snake eats faster than that.
+#define SNAKE_AUTOPILOT_SHORTCUT_LEN (SNAKE_AUTOPILOT_CYCLE_LEN / 2)
+
+typedef struct {
+    uint16_t queue[SNAKE_BOARD_CELLS]; // cells of the search still to look at
+    uint8_t first[SNAKE_BOARD_CELLS]; // first step towards a cell found + 1, 0 not found yet
+    uint32_t steps;
+    uint32_t searches; // paths to the fruit found
+    uint32_t overruns; // searches that ran out of budget
+    uint32_t shortcuts; // steps that skipped part of the cycle
+    // Optional clock for a time budget, set after snake_autopilot_init: a search stops once
+    // it has advanced by `budget` instead of after SNAKE_AUTOPILOT_SEARCH_BUDGET cells.
+    // Differences are taken modulo 2^32. The FAP passes the DWT cycle counter.
+    uint32_t (*now)(void);
+    uint32_t budget;
+} SnakeAutopilot;
+
+void snake_autopilot_init(SnakeAutopilot* const pilot);
+
+// Index of a cell along the cycle, the corner shares one with the cell it stands in for
+uint16_t snake_autopilot_position(Point const p);
+
+// Where the cycle goes from a cell
+Direction snake_autopilot_cycle_direction(Point const p);
+
+// The direction for the next step, to be queued before snake_game_process_game_step
+Direction snake_autopilot_steer(SnakeAutopilot* const pilot, SnakeState const* const snake_state);
@@ -0,0 +1,25 @@
+#include "snake_clock.h"
+
+void snake_clock_reset(SnakeClock* const clock) {
+    clock->played_ms = 0;
+    clock->started_ms = 0;
+    clock->running = false;
+}
+
+void snake_clock_start(SnakeClock* const clock, uint32_t now_ms) {
+    if(!clock->running) {
+        clock->started_ms = now_ms;
+        clock->running = true;
+    }
+}
+
+void snake_clock_stop(SnakeClock* const clock, uint32_t now_ms) {
+    if(clock->running) {
+        clock->played_ms += now_ms - clock->started_ms;
+        clock->running = false;
+    }
+}
+
+uint32_t snake_clock_read_ms(SnakeClock const* const clock, uint32_t now_ms) {
+    return clock->running ? clock->played_ms + (now_ms - clock->started_ms) : clock->played_ms;
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+// Play time of a game.
+// Counted from a monotonic millisecond counter that the platform provides (the kernel
+// tick on the Flipper), so it has millisecond resolution, starting and stopping it costs
+// no clock reads beyond that counter, and setting the RTC mid-game can't disturb it.
+// Differences are taken modulo 2^32, the counter may wrap.
+
+#include <stdbool.h>
+#include <stdint.h>
+
+typedef struct {
+    uint32_t played_ms; // up to the last stop
+    uint32_t started_ms; // counter value at the last start
+    bool running;
+} SnakeClock;
+
+// Zero play time, stopped
+void snake_clock_reset(SnakeClock* const clock);
+
+// Carries on from the time already played, a running clock is left alone
+void snake_clock_start(SnakeClock* const clock, uint32_t now_ms);
+
+// Adds the time since the last start, a stopped clock is left alone
+void snake_clock_stop(SnakeClock* const clock, uint32_t now_ms);
+
+// Play time so far, running or not
+uint32_t snake_clock_read_ms(SnakeClock const* const clock, uint32_t now_ms);
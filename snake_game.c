@@ -0,0 +1,384 @@
+#include "snake_game.h"
+
+#include <string.h>
+
+#include "snake_levels.h"
+#include "snake_profile.h"
+
+static inline void snake_game_occupy(SnakeState* const snake_state, Point const p) {
+    uint16_t cell = snake_game_cell(p);
+    snake_state->occupied[cell >> 3] |= 1 << (cell & 7);
+    snake_state->row_free[p.y]--;
+    snake_state->free_count--;
+}
+
+static inline void snake_game_release(SnakeState* const snake_state, Point const p) {
+    uint16_t cell = snake_game_cell(p);
+    snake_state->occupied[cell >> 3] &= ~(1 << (cell & 7));
+    snake_state->row_free[p.y]++;
+    snake_state->free_count++;
+}
+
+// Also finds the tail, walking the body from the head
+static bool snake_game_fill_occupied(SnakeState* const snake_state) {
+    memset(snake_state->occupied, 0, sizeof(snake_state->occupied));
+
+    // Walls never leave the board, they are kept out of the free counts for good
+    snake_state->free_count = 0;
+    for(uint8_t y = 0; y < SNAKE_BOARD_HEIGHT; y++) {
+        snake_state->row_free[y] = 0;
+        for(uint8_t x = 0; x < SNAKE_BOARD_WIDTH; x++) {
+            Point p = {.x = x, .y = y};
+            if(!snake_game_is_wall(snake_state, p)) {
+                snake_state->row_free[y]++;
+            }
+        }
+        snake_state->free_count += snake_state->row_free[y];
+    }
+    snake_state->open_cells = snake_state->free_count;
+
+    Point p = snake_state->head_point;
+    uint16_t idx = snake_state->head;
+    for(uint16_t i = 0; i < snake_state->len; i++) {
+        if(i) {
+            p = snake_game_neighbour(p, snake_game_body_direction(snake_state, idx));
+            idx = snake_game_next_index(idx);
+        }
+        if(snake_game_collision_with_walls(snake_state, p) ||
+           snake_game_is_occupied(snake_state, p)) {
+            return false;
+        }
+        snake_game_occupy(snake_state, p);
+    }
+    snake_state->tail_point = p;
+    return true;
+}
+
+// Decodes the run lengths of a level into the wall bitmap
+static bool snake_game_decode_level(SnakeState* const snake_state, uint8_t level) {
+    if(level >= snake_level_count) {
+        return false;
+    }
+    memset(snake_state->walls, 0, sizeof(snake_state->walls));
+    snake_state->level = level;
+
+    SnakeLevel const* const map = &snake_levels[level];
+    uint16_t cell = 0;
+    bool wall = false;
+    for(uint16_t i = 0; i < map->size; i++) {
+        uint8_t run = map->rle[i];
+        if(cell + run > SNAKE_BOARD_CELLS) {
+            return false;
+        }
+        if(wall) {
+            for(uint16_t end = cell + run; cell < end; cell++) {
+                snake_state->walls[cell >> 3] |= 1 << (cell & 7);
+            }
+        } else {
+            cell += run;
+        }
+        wall = !wall;
+    }
+    return !map->size || cell == SNAKE_BOARD_CELLS;
+}
+
+void snake_game_init_game(SnakeState* const snake_state, SnakePlatform const* const platform) {
+    // From {8, 6} to {2, 6}
+    snake_state->head_point = (Point){8, 6};
+    snake_state->len = 7;
+    snake_state->head = 0;
+    for(uint16_t i = 0; i + 1 < snake_state->len; i++) {
+        snake_game_set_body_direction(snake_state, i, DirectionLeft);
+    }
+
+    snake_game_decode_level(snake_state, 0);
+    snake_game_fill_occupied(snake_state);
+
+    snake_state->currentMovement = DirectionRight;
+
+    snake_state->nextMovement = DirectionRight;
+
+    snake_state->turn_count = 0;
+
+    Point f = {18, 6};
+    snake_state->fruit = f;
+
+    snake_clock_reset(&snake_state->clock);
+    snake_game_timer_start(snake_state, platform);
+
+    snake_state->state = GameStateLife;
+
+    snake_state->rng = platform->random(platform->ctx);
+    if(!snake_state->rng) {
+        snake_state->rng = 1;
+    }
+    snake_state->steps = 0;
+
+    memset(&snake_state->changes, 0, sizeof(snake_state->changes));
+}
+
+bool snake_game_load_level(SnakeState* const snake_state, uint8_t level) {
+    if(!snake_game_decode_level(snake_state, level) || !snake_game_fill_occupied(snake_state)) {
+        snake_game_decode_level(snake_state, 0);
+        snake_game_fill_occupied(snake_state);
+        return false;
+    }
+    if(snake_game_is_wall(snake_state, snake_state->fruit)) {
+        snake_state->fruit = snake_game_get_new_fruit(snake_state);
+    }
+    return true;
+}
+
+bool snake_game_restore(SnakeState* const snake_state) {
+    if(!snake_game_decode_level(snake_state, snake_state->level)) {
+        return false;
+    }
+    if(snake_state->head >= MAX_SNAKE_LEN || snake_state->len == 0 ||
+       snake_state->len >= MAX_SNAKE_LEN || snake_state->state > GameStateGameOver ||
+       snake_state->currentMovement > DirectionLeft || snake_state->nextMovement > DirectionLeft ||
+       snake_game_collision_with_walls(snake_state, snake_state->fruit) || !snake_state->rng) {
+        return false;
+    }
+
+    snake_state->turn_count = 0;
+
+    // The bitmap, the free counts and the tail are derived from the body, don't trust what
+    // was saved. Filling them also finds a body that leaves the board or runs over itself
+    // or a wall.
+    return snake_game_fill_occupied(snake_state);
+}
+
+void snake_game_timer_start(SnakeState* const snake_state, SnakePlatform const* const platform) {
+    snake_clock_start(&snake_state->clock, platform->get_ms(platform->ctx));
+}
+
+void snake_game_timer_stop(SnakeState* const snake_state, SnakePlatform const* const platform) {
+    snake_clock_stop(&snake_state->clock, platform->get_ms(platform->ctx));
+}
+
+uint32_t snake_game_random(SnakeState* const snake_state) {
+    return snake_game_xorshift(&snake_state->rng);
+}
+
+Point snake_game_get_new_fruit(SnakeState* const snake_state) {
+    // Empty fields for next random fruit = open_cells - len(snake)
+    // They are counted per row on every move, so only the row the draw lands in is scanned.
+    // The n-th free cell in reading order doesn't depend on how the body got there.
+    if(!snake_state->free_count) {
+        return snake_state->fruit;
+    }
+
+    uint16_t n = snake_game_random(snake_state) % snake_state->free_count;
+    Point p = {.x = 0, .y = 0};
+    while(n >= snake_state->row_free[p.y]) {
+        n -= snake_state->row_free[p.y];
+        p.y++;
+    }
+    for(;; p.x++) {
+        if(!snake_game_is_wall(snake_state, p) && !snake_game_is_occupied(snake_state, p)) {
+            if(!n) {
+                break;
+            }
+            n--;
+        }
+    }
+
+    return p;
+}
+
+bool snake_game_collision_with_frame(Point const next_step) {
+    // if x == 0 && currentMovement == left then x - 1 == 255 ,
+    // so check only x > right border
+    return next_step.x >= SNAKE_BOARD_WIDTH || next_step.y >= SNAKE_BOARD_HEIGHT;
+}
+
+bool snake_game_collision_with_walls(SnakeState const* const snake_state, Point const next_step) {
+    // The frame first, a cell past it isn't in the bitmap
+    return snake_game_collision_with_frame(next_step) ||
+           snake_game_is_wall(snake_state, next_step);
+}
+
+bool snake_game_collision_with_tail(SnakeState const* const snake_state, Point const next_step) {
+    // The current tail counts too: it only leaves its cell after the step
+    return snake_game_is_occupied(snake_state, next_step);
+}
+
+Direction snake_game_get_turn_snake(SnakeState const* const snake_state) {
+    // Sum of two `Direction` lies between 0 and 6, odd values indicate orthogonality.
+    bool is_orthogonal = (snake_state->currentMovement + snake_state->nextMovement) % 2 == 1;
+    return is_orthogonal ? snake_state->nextMovement : snake_state->currentMovement;
+}
+
+SnakeTurnResult snake_game_queue_turn(SnakeState* const snake_state, Direction direction) {
+    // With nothing pending the turn goes straight to nextMovement. Whenever turns are
+    // queued, nextMovement holds the first of them, so it is pending too.
+    if(snake_game_get_turn_snake(snake_state) == snake_state->currentMovement) {
+        if((snake_state->currentMovement + direction) % 2 == 0) {
+            return SnakeTurnIgnored;
+        }
+        snake_state->nextMovement = direction;
+        return SnakeTurnQueued;
+    }
+
+    Direction last = snake_state->turn_count ? snake_state->turns[snake_state->turn_count - 1] :
+                                               snake_state->nextMovement;
+    if((last + direction) % 2 == 0) {
+        return SnakeTurnIgnored;
+    }
+    if(snake_state->turn_count == SNAKE_TURN_QUEUE_LEN) {
+        return SnakeTurnDropped;
+    }
+    snake_state->turns[snake_state->turn_count++] = direction;
+    return SnakeTurnQueued;
+}
+
+Point snake_game_get_next_step(SnakeState const* const snake_state) {
+    return snake_game_neighbour(snake_state->head_point, snake_state->currentMovement);
+}
+
+static void
+    snake_game_move_snake(SnakeState* const snake_state, Point const next_step, bool grow) {
+    if(!grow) {
+        // The tail leaves its cell, the segment before it is the tail now. `len` already
+        // excludes the old one after the head moves.
+        Point tail = snake_state->tail_point;
+        snake_game_release(snake_state, tail);
+        snake_state->changes.tail = tail;
+        if(snake_state->len > 1) {
+            uint16_t before = (snake_state->head + snake_state->len - 2) % MAX_SNAKE_LEN;
+            Direction back = (snake_game_body_direction(snake_state, before) + 2) % 4;
+            snake_state->tail_point = snake_game_neighbour(tail, back);
+        } else {
+            snake_state->tail_point = next_step;
+        }
+    }
+    snake_state->changes.moved = true;
+    snake_state->changes.grew = grow;
+
+    // The new head takes the slot in front of the old one and leads back to it, the tail
+    // is cut off by `len`. len is always below MAX_SNAKE_LEN here, so the head never
+    // overwrites a live segment.
+    snake_state->head = snake_state->head == 0 ? MAX_SNAKE_LEN - 1 : snake_state->head - 1;
+    snake_game_set_body_direction(
+        snake_state, snake_state->head, snake_game_direction(next_step, snake_state->head_point));
+    snake_state->head_point = next_step;
+    snake_game_occupy(snake_state, next_step);
+}
+
+void snake_game_unmove_snake(SnakeState* const snake_state, Point const tail, bool grew) {
+    // The head gives its cell back, its segment leads to the old head
+    snake_game_release(snake_state, snake_state->head_point);
+    snake_state->head_point = snake_game_neighbour(
+        snake_state->head_point, snake_game_body_direction(snake_state, snake_state->head));
+    snake_state->head = snake_game_next_index(snake_state->head);
+    if(!grew) {
+        // The entry leading to the tail may have been taken by the head since, it is
+        // written again
+        if(snake_state->len > 1) {
+            uint16_t before = (snake_state->head + snake_state->len - 2) % MAX_SNAKE_LEN;
+            snake_game_set_body_direction(
+                snake_state, before, snake_game_direction(snake_state->tail_point, tail));
+        }
+        snake_state->tail_point = tail;
+        snake_game_occupy(snake_state, tail);
+    }
+}
+
+static void
+    snake_game_step(SnakeState* const snake_state, SnakePlatform const* const platform) {
+    memset(&snake_state->changes, 0, sizeof(snake_state->changes));
+
+    if(snake_state->state == GameStateGameOver) {
+        return;
+    }
+    snake_state->steps++;
+
+    Direction movement = snake_game_get_turn_snake(snake_state);
+    snake_state->changes.turned = movement != snake_state->currentMovement;
+    snake_state->currentMovement = movement;
+    if(snake_state->turn_count) {
+        // The next queued turn waits for the next step
+        snake_state->nextMovement = snake_state->turns[0];
+        snake_state->turn_count--;
+        memmove(
+            snake_state->turns,
+            snake_state->turns + 1,
+            snake_state->turn_count * sizeof(Direction));
+    }
+
+    Point next_step = snake_game_get_next_step(snake_state);
+
+    bool crush = snake_game_collision_with_walls(snake_state, next_step);
+    if(crush) {
+        if(snake_state->state == GameStateLife) {
+            snake_state->state = GameStateLastChance;
+            return;
+        } else if(snake_state->state == GameStateLastChance) {
+            if(snake_state->Endlessmode) {
+                snake_state->state = GameStateLastChance;
+            } else {
+                snake_game_timer_stop(snake_state, platform);
+                snake_state->state = GameStateGameOver;
+            }
+            platform->feedback(platform->ctx, SnakeFeedbackFail);
+            return;
+        }
+    } else {
+        if(snake_state->state == GameStateLastChance) {
+            snake_state->state = GameStateLife;
+        }
+    }
+
+    crush = snake_game_collision_with_tail(snake_state, next_step);
+    if(crush) {
+        if(snake_state->Endlessmode) {
+            snake_state->state = GameStateLastChance;
+        } else {
+            snake_game_timer_stop(snake_state, platform);
+            snake_state->state = GameStateGameOver;
+        }
+        platform->feedback(platform->ctx, SnakeFeedbackFail);
+        return;
+    }
+
+    bool eatFruit = (next_step.x == snake_state->fruit.x) && (next_step.y == snake_state->fruit.y);
+    if(eatFruit) {
+        snake_state->len++;
+
+        if(snake_game_is_won(snake_state)) {
+            //You win!!!
+            //It's impossible to collect ALL fruits, because
+            //the number of rows is odd (SNAKE_BOARD_HEIGHT),
+            //the number of columnss is odd too (SNAKE_BOARD_WIDTH).
+            //You just can't locate the snake's body
+            //on the odd number of cells.
+            //Because of it you win when you collect
+            //all but one fruits.
+            //On a level the walls don't count.
+
+            snake_game_timer_stop(snake_state, platform);
+            snake_state->state = GameStateGameOver;
+            platform->feedback(platform->ctx, SnakeFeedbackFail);
+            return;
+        }
+    }
+
+    snake_game_move_snake(snake_state, next_step, eatFruit);
+
+    if(eatFruit) {
+        snake_state->changes.fruit_moved = true;
+        snake_state->changes.old_fruit = snake_state->fruit;
+        SNAKE_PROFILE_BEGIN(SnakeProfileSpawn);
+        snake_state->fruit = snake_game_get_new_fruit(snake_state);
+        SNAKE_PROFILE_END(SnakeProfileSpawn);
+        platform->feedback(platform->ctx, SnakeFeedbackEat);
+    }
+}
+
+void snake_game_process_game_step(
+    SnakeState* const snake_state,
+    SnakePlatform const* const platform) {
+    SNAKE_PROFILE_BEGIN(SnakeProfileStep);
+    snake_game_step(snake_state, platform);
+    SNAKE_PROFILE_END(SnakeProfileStep);
+}
@@ -0,0 +1,234 @@
+#pragma once
+
+// Game rules of Snake 2.0.
+// This part knows nothing about the Flipper: millisecond counter, seeds and sound/vibro
+// feedback come in through SnakePlatform, so the same code runs inside the FAP
+// and in the host build (see host/Makefile). Given the seed and the inputs a
+// game always plays out the same way, which is what replays rely on.
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "snake_clock.h"
+
+typedef struct {
+    //    +-----x
+    //    |
+    //    |
+    //    y
+    uint8_t x;
+    uint8_t y;
+} Point;
+
+typedef enum {
+    GameStateLife,
+    GameStatePause,
+    GameStateLastChance,
+    GameStateGameOver,
+} GameState;
+
+typedef enum {
+    DirectionUp,
+    DirectionRight,
+    DirectionDown,
+    DirectionLeft,
+} Direction;
+
+// Board size in cells, fixed at compile time. The classic board is 31x15 cells of 4 px,
+// SNAKE_BIG_BOARD builds 63x31 cells of 2 px (see SNAKE_CELL_SIZE in snake_render.h).
+// Both sides have to be odd for the win condition, see snake_game_process_game_step.
+#ifdef SNAKE_BIG_BOARD
+#define SNAKE_BOARD_WIDTH 63
+#define SNAKE_BOARD_HEIGHT 31
+#else
+#define SNAKE_BOARD_WIDTH 31
+#define SNAKE_BOARD_HEIGHT 15
+#endif
+#define SNAKE_BOARD_CELLS (SNAKE_BOARD_WIDTH * SNAKE_BOARD_HEIGHT)
+
+#define MAX_SNAKE_LEN SNAKE_BOARD_CELLS
+#define OCCUPIED_BYTES ((SNAKE_BOARD_CELLS + 7) / 8)
+#define BODY_BYTES ((MAX_SNAKE_LEN + 3) / 4)
+#define SNAKE_TURN_QUEUE_LEN 3 // turns waiting behind nextMovement
+
+// What the last snake_game_process_game_step changed on the board,
+// lets the renderer update only the touched cells
+typedef struct {
+    bool moved; // the head advanced, the previous head is next to it along the body
+    bool grew; // the tail stayed where it was
+    Point tail; // the cell the tail left, if moved and not grew
+    bool fruit_moved;
+    Point old_fruit;
+    bool turned; // a turn from nextMovement was taken
+} SnakeStepChanges;
+
+// The state stays around 1 KB on the big board: the body is 2 bits a segment and the
+// cells are bits, see snake_game_get_new_fruit for the free ones.
+typedef struct {
+    // Ring buffer of 2 bit directions, entry i leads from segment i to the one after it
+    // towards the tail. The head is segment `head`, the cells of both ends are kept.
+    uint8_t body[BODY_BYTES];
+    Point head_point;
+    Point tail_point;
+    uint16_t len;
+    uint16_t head;
+    uint8_t occupied[OCCUPIED_BYTES]; // one bit per cell taken by the snake's body
+    uint8_t level; // index into snake_levels, 0 is the plain board
+    uint8_t walls[OCCUPIED_BYTES]; // one bit per wall cell of the level
+    uint16_t open_cells; // cells that aren't walls
+    uint8_t row_free[SNAKE_BOARD_HEIGHT]; // open cells of each row not taken by the body
+    uint16_t free_count;
+    Direction currentMovement;
+    Direction nextMovement; // if backward of currentMovement, ignore
+    // Turns pressed faster than the snake steps, taken one per step after nextMovement.
+    // Not saved: a save is only made between steps, when at most nextMovement is pending.
+    Direction turns[SNAKE_TURN_QUEUE_LEN];
+    uint8_t turn_count;
+    Point fruit;
+    GameState state;
+    bool Endlessmode;
+    SnakeClock clock; // play time, stopped while paused and after game over
+    uint32_t rng; // xorshift32 state, never 0
+    uint32_t steps; // calls of snake_game_process_game_step since the game started
+    SnakeStepChanges changes;
+} SnakeState;
+
+typedef enum {
+    SnakeTurnQueued,
+    SnakeTurnIgnored, // not a turn from where the snake will be heading by then
+    SnakeTurnDropped, // the queue is full
+} SnakeTurnResult;
+
+typedef enum {
+    SnakeFeedbackFail,
+    SnakeFeedbackEat,
+} SnakeFeedback;
+
+typedef struct {
+    uint32_t (*get_ms)(void* ctx); // monotonic milliseconds, may wrap
+    uint32_t (*random)(void* ctx); // seeds new games
+    void (*feedback)(void* ctx, SnakeFeedback feedback);
+    void* ctx;
+} SnakePlatform;
+
+static inline uint16_t snake_game_next_index(uint16_t idx) {
+    // Walks the ring buffer of points from the head to the tail
+    return idx + 1 == MAX_SNAKE_LEN ? 0 : idx + 1;
+}
+
+// Direction from segment `idx` of the ring to the next one along the body
+static inline Direction
+    snake_game_body_direction(SnakeState const* const snake_state, uint16_t idx) {
+    return (snake_state->body[idx >> 2] >> ((idx & 3) * 2)) & 3;
+}
+
+static inline void snake_game_set_body_direction(
+    SnakeState* const snake_state,
+    uint16_t idx,
+    Direction direction) {
+    uint8_t shift = (idx & 3) * 2;
+    uint8_t* byte = &snake_state->body[idx >> 2];
+    *byte = (*byte & ~(3 << shift)) | direction << shift;
+}
+
+// The cell next to `p`, past the frame it wraps to 255 like snake_game_get_next_step
+static inline Point snake_game_neighbour(Point p, Direction direction) {
+    switch(direction) {
+    case DirectionUp:
+        p.y--;
+        break;
+    case DirectionRight:
+        p.x++;
+        break;
+    case DirectionDown:
+        p.y++;
+        break;
+    case DirectionLeft:
+        p.x--;
+        break;
+    }
+    return p;
+}
+
+// From a cell to one next to it
+static inline Direction snake_game_direction(Point const from, Point const to) {
+    if(to.x != from.x) {
+        return to.x > from.x ? DirectionRight : DirectionLeft;
+    }
+    return to.y > from.y ? DirectionDown : DirectionUp;
+}
+
+// One step of xorshift32, the generator of the game, of the arena and of the host players.
+// `rng` is never 0.
+static inline uint32_t snake_game_xorshift(uint32_t* const rng) {
+    uint32_t x = *rng;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *rng = x;
+    return x;
+}
+
+static inline uint16_t snake_game_cell(Point const p) {
+    return p.x + SNAKE_BOARD_WIDTH * p.y;
+}
+
+static inline bool snake_game_is_occupied(SnakeState const* const snake_state, Point const p) {
+    uint16_t cell = snake_game_cell(p);
+    return snake_state->occupied[cell >> 3] & (1 << (cell & 7));
+}
+
+static inline bool snake_game_is_wall(SnakeState const* const snake_state, Point const p) {
+    uint16_t cell = snake_game_cell(p);
+    return snake_state->walls[cell >> 3] & (1 << (cell & 7));
+}
+
+// The game is won with every open cell but one taken, see snake_game_process_game_step
+static inline bool snake_game_is_won(SnakeState const* const snake_state) {
+    return snake_state->len >= snake_state->open_cells - 1;
+}
+
+// Starts a new game on the plain board
+void snake_game_init_game(SnakeState* const snake_state, SnakePlatform const* const platform);
+
+// Puts the walls of a level (see snake_levels.h) on the board of a game that was just
+// initialized. Returns false if there is no such level, the game stays on its board then.
+bool snake_game_load_level(SnakeState* const snake_state, uint8_t level);
+
+// Rebuilds everything derived from the body after the state was read from a save.
+// Returns false if the state doesn't describe a valid snake.
+bool snake_game_restore(SnakeState* const snake_state);
+
+void snake_game_timer_start(SnakeState* const snake_state, SnakePlatform const* const platform);
+
+void snake_game_timer_stop(SnakeState* const snake_state, SnakePlatform const* const platform);
+
+// Draws from the game's own generator, advancing it
+uint32_t snake_game_random(SnakeState* const snake_state);
+
+Point snake_game_get_new_fruit(SnakeState* const snake_state);
+
+bool snake_game_collision_with_frame(Point const next_step);
+
+// The frame or a wall of the level, one bit lookup whatever the level
+bool snake_game_collision_with_walls(SnakeState const* const snake_state, Point const next_step);
+
+bool snake_game_collision_with_tail(SnakeState const* const snake_state, Point const next_step);
+
+Direction snake_game_get_turn_snake(SnakeState const* const snake_state);
+
+// Queues a change of direction. Like nextMovement it has to be orthogonal, but to the
+// last turn still waiting rather than to the current movement, so two quick presses
+// make a U-turn over two steps instead of the second one overwriting the first.
+SnakeTurnResult snake_game_queue_turn(SnakeState* const snake_state, Direction direction);
+
+Point snake_game_get_next_step(SnakeState const* const snake_state);
+
+void snake_game_process_game_step(
+    SnakeState* const snake_state,
+    SnakePlatform const* const platform);
+
+// Undoes the move of the last step: the head goes back one cell and, unless the snake
+// grew, the tail comes back on `tail`. With `grew` the caller takes len back down after.
+void snake_game_unmove_snake(SnakeState* const snake_state, Point const tail, bool grew);
@@ -0,0 +1,160 @@
+#include "snake_journal.h"
+
+#include <string.h>
+
+static const uint8_t snake_journal_magic[4] = {'S', 'N', 'R', '1'};
+
+#define SNAKE_JOURNAL_FLAG_TRUNCATED 1
+
+void snake_journal_start(SnakeJournal* const journal, SnakeState const* const snake_state) {
+    journal->start_size = snake_save_encode(
+        snake_state, journal->data + SNAKE_JOURNAL_HEADER_SIZE, SNAKE_SAVE_MAX_SIZE);
+    journal->events_size = 0;
+    journal->start_step = snake_state->steps;
+    journal->last_step = snake_state->steps;
+    journal->truncated = false;
+    journal->truncated_step = 0;
+}
+
+void snake_journal_record(
+    SnakeJournal* const journal,
+    SnakeState const* const snake_state,
+    SnakeJournalEvent event) {
+    if(journal->truncated) {
+        return;
+    }
+
+    uint8_t varint[5];
+    size_t size = 0;
+    uint32_t value = (snake_state->steps - journal->last_step) << 3 | event;
+    do {
+        varint[size] = value & 0x7F;
+        value >>= 7;
+        if(value) {
+            varint[size] |= 0x80;
+        }
+        size++;
+    } while(value);
+
+    if(journal->events_size + size > SNAKE_JOURNAL_EVENTS_SIZE) {
+        // Everything up to here still replays, the rest of the game is lost
+        journal->truncated = true;
+        journal->truncated_step = snake_state->steps - journal->start_step;
+        return;
+    }
+
+    uint8_t* events = journal->data + SNAKE_JOURNAL_HEADER_SIZE + journal->start_size;
+    memcpy(events + journal->events_size, varint, size);
+    journal->events_size += size;
+    journal->last_step = snake_state->steps;
+}
+
+size_t snake_journal_finish(SnakeJournal* const journal, SnakeState const* const snake_state) {
+    uint32_t steps = journal->truncated ? journal->truncated_step :
+                                          snake_state->steps - journal->start_step;
+    size_t body_size = journal->start_size + journal->events_size;
+    uint8_t* header = journal->data;
+
+    memcpy(header, snake_journal_magic, sizeof(snake_journal_magic));
+    header[4] = SNAKE_JOURNAL_VERSION_MAJOR;
+    header[5] = SNAKE_JOURNAL_VERSION_MINOR;
+    header[6] = journal->truncated ? SNAKE_JOURNAL_FLAG_TRUNCATED : 0;
+    header[7] = 0;
+    snake_save_put_u32(&header[8], steps);
+    snake_save_put_u16(&header[12], journal->start_size);
+    snake_save_put_u16(&header[14], journal->events_size);
+    snake_save_put_u32(
+        &header[16], snake_save_crc32(header + SNAKE_JOURNAL_HEADER_SIZE, body_size));
+
+    return SNAKE_JOURNAL_HEADER_SIZE + body_size;
+}
+
+void snake_journal_apply(
+    SnakeState* const snake_state,
+    SnakeJournalEvent event,
+    SnakePlatform const* const platform) {
+    switch(event) {
+    case SnakeJournalEventUp:
+    case SnakeJournalEventRight:
+    case SnakeJournalEventDown:
+    case SnakeJournalEventLeft:
+        snake_game_queue_turn(snake_state, (Direction)event);
+        break;
+    case SnakeJournalEventEndless:
+        snake_state->Endlessmode = !snake_state->Endlessmode;
+        break;
+    case SnakeJournalEventGiveUp:
+        // Like a crash, the time played ends here
+        snake_state->state = GameStateGameOver;
+        snake_game_timer_stop(snake_state, platform);
+        break;
+    }
+}
+
+// Reads the next event, a damaged tail simply ends the replay early
+static void snake_replay_next_event(SnakeReplay* const replay) {
+    uint32_t value = 0;
+    for(uint8_t shift = 0;; shift += 7) {
+        if(replay->pos >= replay->events_size || shift > 28) {
+            replay->has_event = false;
+            return;
+        }
+        uint8_t byte = replay->events[replay->pos++];
+        value |= (uint32_t)(byte & 0x7F) << shift;
+        if(!(byte & 0x80)) {
+            break;
+        }
+    }
+
+    replay->next_step += value >> 3;
+    replay->next_event = value & 7;
+    replay->has_event = replay->next_event <= SnakeJournalEventGiveUp;
+}
+
+bool snake_replay_start(
+    SnakeReplay* const replay,
+    SnakeState* const snake_state,
+    const uint8_t* data,
+    size_t size) {
+    if(size < SNAKE_JOURNAL_HEADER_SIZE ||
+       memcmp(data, snake_journal_magic, sizeof(snake_journal_magic)) != 0 ||
+       data[4] != SNAKE_JOURNAL_VERSION_MAJOR) {
+        return false;
+    }
+
+    size_t start_size = snake_save_get_u16(&data[12]);
+    size_t events_size = snake_save_get_u16(&data[14]);
+    size_t body_size = start_size + events_size;
+    const uint8_t* body = data + SNAKE_JOURNAL_HEADER_SIZE;
+    if(SNAKE_JOURNAL_HEADER_SIZE + body_size > size ||
+       snake_save_crc32(body, body_size) != snake_save_get_u32(&data[16]) ||
+       !snake_save_decode(snake_state, body, start_size)) {
+        return false;
+    }
+
+    replay->events = body + start_size;
+    replay->events_size = events_size;
+    replay->pos = 0;
+    replay->steps = snake_save_get_u32(&data[8]);
+    replay->start_step = snake_state->steps;
+    replay->next_step = 0;
+    snake_replay_next_event(replay);
+    return true;
+}
+
+bool snake_replay_step(
+    SnakeReplay* const replay,
+    SnakeState* const snake_state,
+    SnakePlatform const* const platform) {
+    uint32_t step = snake_state->steps - replay->start_step;
+    while(replay->has_event && replay->next_step <= step) {
+        snake_journal_apply(snake_state, replay->next_event, platform);
+        snake_replay_next_event(replay);
+    }
+
+    if(step >= replay->steps || snake_state->state == GameStateGameOver) {
+        return false;
+    }
+    snake_game_process_game_step(snake_state, platform);
+    return true;
+}
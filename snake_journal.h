@@ -0,0 +1,90 @@
+#pragma once
+
+// Recording and replay of games.
+//
+// A journal is the state a game started from, in the save format, which carries the
+// random generator, plus every input that changed the course of the game, tagged with
+// the step it came before. The rules are deterministic, so feeding the inputs back at
+// the same steps plays the game out exactly as it went.
+//
+// Replay file, little endian:
+//   header, 20 bytes: "SNR1" magic, major version, minor version, flags (bit 0: the events
+//   ran out of space and the recording stops early), reserved byte, steps played (u32),
+//   size of the start state (u16), size of the events (u16), CRC-32 of the rest
+//   start state as written by snake_save_encode
+//   events: varint of (steps since the previous event << 3 | SnakeJournalEvent)
+
+#include "snake_game.h"
+#include "snake_save.h"
+
+#define SNAKE_JOURNAL_VERSION_MAJOR 2
+#define SNAKE_JOURNAL_VERSION_MINOR 0
+
+#define SNAKE_JOURNAL_HEADER_SIZE 20
+#define SNAKE_JOURNAL_EVENTS_SIZE 4096 // about 2000 turns
+#define SNAKE_JOURNAL_MAX_SIZE \
+    (SNAKE_JOURNAL_HEADER_SIZE + SNAKE_SAVE_MAX_SIZE + SNAKE_JOURNAL_EVENTS_SIZE)
+
+typedef enum {
+    // The first four are a turn for snake_game_queue_turn, same values as Direction
+    SnakeJournalEventUp,
+    SnakeJournalEventRight,
+    SnakeJournalEventDown,
+    SnakeJournalEventLeft,
+    SnakeJournalEventEndless, // Endless mode switched on or off
+    SnakeJournalEventGiveUp, // the player ended the game
+} SnakeJournalEvent;
+
+typedef struct {
+    uint8_t data[SNAKE_JOURNAL_MAX_SIZE]; // the replay file being built
+    size_t start_size;
+    size_t events_size;
+    uint32_t start_step; // SnakeState.steps when recording began
+    uint32_t last_step; // of the last event
+    bool truncated;
+    uint32_t truncated_step; // the first step with inputs that didn't fit
+} SnakeJournal;
+
+// Begins a recording from the current state, for a new game or a loaded one
+void snake_journal_start(SnakeJournal* const journal, SnakeState const* const snake_state);
+
+// Call right after the input was applied to the state
+void snake_journal_record(
+    SnakeJournal* const journal,
+    SnakeState const* const snake_state,
+    SnakeJournalEvent event);
+
+// Completes the header, the replay file is the first `size` bytes of journal->data
+size_t snake_journal_finish(SnakeJournal* const journal, SnakeState const* const snake_state);
+
+// Applies one recorded input to the state the way the app does, a give-up stops the clock
+void snake_journal_apply(
+    SnakeState* const snake_state,
+    SnakeJournalEvent event,
+    SnakePlatform const* const platform);
+
+typedef struct {
+    const uint8_t* events;
+    size_t events_size;
+    size_t pos;
+    uint32_t steps; // recorded steps, counted from start_step
+    uint32_t start_step;
+    uint32_t next_step; // of the next event, counted from start_step
+    uint8_t next_event;
+    bool has_event;
+} SnakeReplay;
+
+// Checks a replay file and puts the state where the recording began.
+// `data` must stay around until the replay is over.
+bool snake_replay_start(
+    SnakeReplay* const replay,
+    SnakeState* const snake_state,
+    const uint8_t* data,
+    size_t size);
+
+// Applies the inputs recorded before the next step and plays it.
+// Returns false, without playing a step, once the recording is over.
+bool snake_replay_step(
+    SnakeReplay* const replay,
+    SnakeState* const snake_state,
+    SnakePlatform const* const platform);
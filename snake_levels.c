@@ -0,0 +1,63 @@
+// Generated by host/levels.py from levels/*.txt, edit those and run make -C host levels
+
+#include "snake_levels.h"
+
+#include <stddef.h>
+
+#ifdef SNAKE_BIG_BOARD
+// 1_pillars.txt, 67 bytes
+static const uint8_t level_1[] = {
+    255, 0, 69, 4, 10, 4, 10, 4, 10, 4, 17, 4,
+    10, 4, 10, 4, 10, 4, 17, 4, 10, 4, 10, 4,
+    10, 4, 17, 4, 10, 4, 10, 4, 10, 4, 255, 0,
+    255, 0, 255, 0, 14, 4, 10, 4, 10, 4, 31, 4,
+    10, 4, 10, 4, 31, 4, 10, 4, 10, 4, 31, 4,
+    10, 4, 10, 4, 255, 0, 139,
+};
+
+// 2_box.txt, 67 bytes
+static const uint8_t level_2[] = {
+    196, 20, 10, 20, 13, 20, 10, 20, 135, 2, 54, 2,
+    5, 2, 54, 2, 5, 2, 54, 2, 5, 2, 54, 2,
+    5, 2, 54, 2, 5, 2, 54, 2, 255, 0, 128, 2,
+    54, 2, 5, 2, 54, 2, 5, 2, 54, 2, 5, 2,
+    54, 2, 5, 2, 54, 2, 5, 2, 54, 2, 135, 20,
+    10, 20, 13, 20, 10, 20, 132,
+};
+
+// 3_bars.txt, 33 bytes
+static const uint8_t level_3[] = {
+    255, 0, 195, 46, 17, 46, 183, 2, 61, 2, 61, 2,
+    61, 2, 61, 2, 61, 2, 61, 2, 61, 2, 61, 2,
+    61, 2, 147, 46, 17, 46, 255, 0, 131,
+};
+#else
+// 1_pillars.txt, 29 bytes
+static const uint8_t level_1[] = {
+    66, 2, 5, 2, 5, 2, 5, 2, 8, 2, 5, 2,
+    5, 2, 5, 2, 197, 2, 5, 2, 5, 2, 15, 2,
+    5, 2, 5, 2, 101,
+};
+
+// 2_box.txt, 33 bytes
+static const uint8_t level_2[] = {
+    34, 10, 5, 10, 35, 1, 27, 1, 2, 1, 27, 1,
+    2, 1, 27, 1, 95, 1, 27, 1, 2, 1, 27, 1,
+    2, 1, 27, 1, 35, 10, 5, 10, 34,
+};
+
+// 3_bars.txt, 15 bytes
+static const uint8_t level_3[] = {
+    97, 23, 59, 1, 30, 1, 30, 1, 30, 1, 30, 1,
+    41, 23, 97,
+};
+#endif
+
+const uint8_t snake_level_count = 4;
+
+const SnakeLevel snake_levels[] = {
+    {.name = "Plain", .rle = NULL, .size = 0},
+    {.name = "Pillars", .rle = level_1, .size = sizeof(level_1)},
+    {.name = "Box", .rle = level_2, .size = sizeof(level_2)},
+    {.name = "Bars", .rle = level_3, .size = sizeof(level_3)},
+};
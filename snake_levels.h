@@ -0,0 +1,19 @@
+#pragma once
+
+// Built-in levels: walls inside the board on top of the frame around it.
+//
+// The maps are levels/*.txt, host/levels.py compiles them into snake_levels.c for both
+// board sizes. A level is the run lengths of open and wall cells, alternating and
+// starting with open ones, over the cells row by row: a byte each, a run over 255 is
+// 255, an empty run of the other kind and the rest. Level 0 is the plain board.
+
+#include <stdint.h>
+
+typedef struct {
+    const char* name;
+    const uint8_t* rle; // NULL for no walls
+    uint16_t size;
+} SnakeLevel;
+
+extern const uint8_t snake_level_count;
+extern const SnakeLevel snake_levels[];
@@ -0,0 +1,145 @@
+#if defined(SNAKE_PROFILE) && !defined(APP_SNAKE_20)
+#define _POSIX_C_SOURCE 199309L
+#endif
+
+#include "snake_profile.h"
+
+#ifdef SNAKE_PROFILE
+
+#include <stdio.h>
+#include <string.h>
+
+// APP_SNAKE_20 comes from application.fam, so only the FAP reads the DWT counter. An ARM
+// host build still takes clock_gettime.
+#ifdef APP_SNAKE_20
+#include <furi_hal.h>
+#else
+#include <time.h>
+#endif
+
+static SnakeProfileCounter snake_profile_counters[SnakeProfilePhaseCount];
+
+static const char* const snake_profile_names[SnakeProfilePhaseCount] = {
+    "input",
+    "step",
+    "spawn",
+    "render",
+    "save",
+    "load",
+    "pilot",
+};
+
+#ifdef APP_SNAKE_20
+
+const char* const snake_profile_unit = "cycles";
+
+uint32_t snake_profile_now(void) {
+    // The firmware enables the DWT cycle counter at boot
+    return DWT->CYCCNT;
+}
+
+#else
+
+const char* const snake_profile_unit = "ns";
+
+uint32_t snake_profile_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    // Wraps every 4 s, differences are still right for anything shorter
+    return (uint32_t)ts.tv_sec * 1000000000U + (uint32_t)ts.tv_nsec;
+}
+
+#endif
+
+void snake_profile_add(SnakeProfilePhase phase, uint32_t time) {
+    SnakeProfileCounter* counter = &snake_profile_counters[phase];
+    if(!counter->count || time < counter->min) {
+        counter->min = time;
+    }
+    if(time > counter->max) {
+        counter->max = time;
+    }
+    counter->sum += time;
+    counter->count++;
+
+    uint8_t bucket = 0;
+    for(uint32_t bound = 4; bucket + 1 < SNAKE_PROFILE_BUCKETS && time >= bound; bound <<= 2) {
+        bucket++;
+    }
+    counter->histogram[bucket]++;
+}
+
+void snake_profile_reset(void) {
+    memset(snake_profile_counters, 0, sizeof(snake_profile_counters));
+}
+
+SnakeProfileCounter const* snake_profile_get(SnakeProfilePhase phase) {
+    return &snake_profile_counters[phase];
+}
+
+const char* snake_profile_phase_name(SnakeProfilePhase phase) {
+    return snake_profile_names[phase];
+}
+
+// Fits a time into 5 characters
+static void snake_profile_format_value(uint32_t value, char* buffer, size_t size) {
+    if(value < 100000) {
+        snprintf(buffer, size, "%lu", (unsigned long)value);
+    } else if(value < 100000000) {
+        snprintf(buffer, size, "%luk", (unsigned long)(value / 1000));
+    } else {
+        snprintf(buffer, size, "%luM", (unsigned long)(value / 1000000));
+    }
+}
+
+void snake_profile_format_line(SnakeProfilePhase phase, char* buffer, size_t size) {
+    SnakeProfileCounter const* counter = &snake_profile_counters[phase];
+    char avg[8];
+    char max[8];
+    snake_profile_format_value(
+        counter->count ? (uint32_t)(counter->sum / counter->count) : 0, avg, sizeof(avg));
+    snake_profile_format_value(counter->max, max, sizeof(max));
+    snprintf(
+        buffer,
+        size,
+        "%-6s %5s %5s %lu",
+        snake_profile_names[phase],
+        avg,
+        max,
+        (unsigned long)counter->count);
+}
+
+size_t snake_profile_format_report(char* buffer, size_t size) {
+    size_t length = 0;
+#define SNAKE_PROFILE_PRINT(...)                                                      \
+    do {                                                                              \
+        if(length < size) {                                                           \
+            int written = snprintf(buffer + length, size - length, __VA_ARGS__);      \
+            length = written < 0 ? size : length + (size_t)written;                   \
+        }                                                                             \
+    } while(0)
+
+    SNAKE_PROFILE_PRINT("phase count min avg max (%s)\n", snake_profile_unit);
+    for(uint8_t phase = 0; phase < SnakeProfilePhaseCount; phase++) {
+        SnakeProfileCounter const* counter = &snake_profile_counters[phase];
+        SNAKE_PROFILE_PRINT(
+            "%s %lu %lu %lu %lu\n  histogram, by powers of 4:",
+            snake_profile_names[phase],
+            (unsigned long)counter->count,
+            (unsigned long)counter->min,
+            (unsigned long)(counter->count ? counter->sum / counter->count : 0),
+            (unsigned long)counter->max);
+        for(uint8_t bucket = 0; bucket < SNAKE_PROFILE_BUCKETS; bucket++) {
+            SNAKE_PROFILE_PRINT(" %lu", (unsigned long)counter->histogram[bucket]);
+        }
+        SNAKE_PROFILE_PRINT("\n");
+    }
+#undef SNAKE_PROFILE_PRINT
+
+    if(length >= size) {
+        length = size ? size - 1 : 0;
+    }
+    return length;
+}
+
+#endif
@@ -0,0 +1,68 @@
+#pragma once
+
+// Timing of the hot paths, compiled in only with SNAKE_PROFILE defined (add it to
+// cdefines in application.fam, or `make -C host PROFILE=1`). Without it the macros
+// below expand to nothing.
+//
+// Each phase keeps min/avg/max and a histogram with one bucket per power of 4. Times are
+// CPU cycles of the DWT counter on the Flipper (64 MHz) and nanoseconds on the host.
+// A phase must be timed from one thread only. Readers on other threads may see a sample
+// half added, which is good enough for a debug readout.
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef enum {
+    SnakeProfileInput, // a key event in the game loop
+    SnakeProfileStep, // snake_game_process_game_step
+    SnakeProfileSpawn, // snake_game_get_new_fruit, part of a step
+    SnakeProfileRender, // the draw callback
+    SnakeProfileSave, // writing the save file
+    SnakeProfileLoad, // reading it at startup
+    SnakeProfilePilot, // snake_autopilot_steer
+    SnakeProfilePhaseCount,
+} SnakeProfilePhase;
+
+#define SNAKE_PROFILE_BUCKETS 16 // bucket i counts times in [4^i, 4^(i+1))
+
+typedef struct {
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint64_t sum;
+    uint32_t histogram[SNAKE_PROFILE_BUCKETS];
+} SnakeProfileCounter;
+
+#ifdef SNAKE_PROFILE
+
+#define SNAKE_PROFILE_BEGIN(phase) uint32_t snake_profile_start_##phase = snake_profile_now()
+#define SNAKE_PROFILE_END(phase) \
+    snake_profile_add(phase, snake_profile_now() - snake_profile_start_##phase)
+
+// "cycles" or "ns"
+extern const char* const snake_profile_unit;
+
+uint32_t snake_profile_now(void);
+
+void snake_profile_add(SnakeProfilePhase phase, uint32_t time);
+
+void snake_profile_reset(void);
+
+SnakeProfileCounter const* snake_profile_get(SnakeProfilePhase phase);
+
+const char* snake_profile_phase_name(SnakeProfilePhase phase);
+
+// One short line for the debug overlay: name, average, maximum, count
+void snake_profile_format_line(SnakeProfilePhase phase, char* buffer, size_t size);
+
+// Everything, histograms included, as text for the log file.
+// Returns the length written, like snprintf clamped to the buffer.
+size_t snake_profile_format_report(char* buffer, size_t size);
+
+#else
+
+#define SNAKE_PROFILE_BEGIN(phase)
+#define SNAKE_PROFILE_END(phase)
+
+#endif
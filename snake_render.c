@@ -0,0 +1,561 @@
+#include "snake_render.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "snake20_icons.h"
+
+// Top left corners of the glyphs in images/
+#define x_back_symbol 47
+#define y_back_symbol 2
+
+#define x_arrow_left 81
+#define y_arrow_left 14
+
+#define x_arrow_right 104
+#define y_arrow_right 14
+
+#ifndef MIN
+#define MIN(a, b) ((a) < (b) ? (a) : (b))
+#endif
+#ifndef MAX
+#define MAX(a, b) ((a) > (b) ? (a) : (b))
+#endif
+
+#define PLAYFIELD_STRIDE (SNAKE_PLAYFIELD_WIDTH / 8)
+
+// Top left pixel of a cell
+#define CELL_X(x) (SNAKE_BOARD_X + (x) * SNAKE_CELL_SIZE)
+#define CELL_Y(y) (SNAKE_BOARD_Y + (y) * SNAKE_CELL_SIZE)
+
+// The head is a cell with a hole in the middle
+#define HEAD_MARK_OFFSET (SNAKE_CELL_SIZE / 4)
+#define HEAD_MARK_SIZE (SNAKE_CELL_SIZE / 2)
+
+// One byte per row, bit N is the column N, drawn at FRUIT_SPRITE_X/Y from the top left of
+// the fruit's cell. The core is set in two rows from FRUIT_SPRITE_CORE_ROW outside Endless mode.
+#if SNAKE_CELL_SIZE >= 4
+// Apple: the 6x6 rounded frame and the stem. Same pixels as canvas_draw_rframe(6, 6, 2) + dots.
+static const uint8_t fruit_sprite[] = {0x10, 0x08, 0x1E, 0x21, 0x21, 0x21, 0x21, 0x1E};
+#define FRUIT_SPRITE_WIDTH 6
+#define FRUIT_SPRITE_CORE 0x0C
+#define FRUIT_SPRITE_CORE_ROW 4
+#define FRUIT_SPRITE_X (-1)
+#define FRUIT_SPRITE_Y (-3)
+#else
+// No room for the apple on small cells: a ring around the cell
+static const uint8_t fruit_sprite[] = {0x06, 0x09, 0x09, 0x06};
+#define FRUIT_SPRITE_WIDTH 4
+#define FRUIT_SPRITE_CORE 0x06
+#define FRUIT_SPRITE_CORE_ROW 1
+#define FRUIT_SPRITE_X (-1)
+#define FRUIT_SPRITE_Y (-1)
+#endif
+
+typedef struct {
+    // Half-open pixel rectangle [x0, x1) x [y0, y1)
+    int16_t x0;
+    int16_t y0;
+    int16_t x1;
+    int16_t y1;
+} SnakeRect;
+
+static inline void snake_playfield_pixel(
+    SnakePlayfield* const playfield,
+    SnakeRect const* const clip,
+    int16_t x,
+    int16_t y,
+    bool black) {
+    if(x < clip->x0 || y < clip->y0 || x >= clip->x1 || y >= clip->y1) {
+        return;
+    }
+    uint8_t* byte = &playfield->bits[y * PLAYFIELD_STRIDE + x / 8];
+    if(black) {
+        *byte |= 1 << (x % 8);
+    } else {
+        *byte &= ~(1 << (x % 8));
+    }
+}
+
+static void snake_playfield_box(
+    SnakePlayfield* const playfield,
+    SnakeRect const* const clip,
+    int16_t x,
+    int16_t y,
+    int16_t w,
+    int16_t h,
+    bool black) {
+    int16_t x0 = MAX(x, clip->x0);
+    int16_t y0 = MAX(y, clip->y0);
+    int16_t x1 = MIN(x + w, clip->x1);
+    int16_t y1 = MIN(y + h, clip->y1);
+    for(int16_t py = y0; py < y1; py++) {
+        for(int16_t px = x0; px < x1; px++) {
+            snake_playfield_pixel(playfield, clip, px, py, black);
+        }
+    }
+}
+
+static SnakeRect snake_playfield_cell_rect(Point const p) {
+    SnakeRect rect = {
+        .x0 = CELL_X(p.x),
+        .y0 = CELL_Y(p.y),
+        .x1 = CELL_X(p.x) + SNAKE_CELL_SIZE,
+        .y1 = CELL_Y(p.y) + SNAKE_CELL_SIZE,
+    };
+    return rect;
+}
+
+static SnakeRect snake_playfield_fruit_rect(Point const p) {
+    SnakeRect rect = {
+        .x0 = CELL_X(p.x) + FRUIT_SPRITE_X,
+        .y0 = CELL_Y(p.y) + FRUIT_SPRITE_Y,
+        .x1 = CELL_X(p.x) + FRUIT_SPRITE_X + FRUIT_SPRITE_WIDTH,
+        .y1 = CELL_Y(p.y) + FRUIT_SPRITE_Y + sizeof(fruit_sprite),
+    };
+    return rect;
+}
+
+// Clips `rect` to the screen and clears it, returns false if nothing of it is visible
+static bool snake_playfield_clear(
+    SnakePlayfield* const playfield,
+    SnakeRect const rect,
+    SnakeRect* const clip) {
+    clip->x0 = MAX(rect.x0, 0);
+    clip->y0 = MAX(rect.y0, 0);
+    clip->x1 = MIN(rect.x1, SNAKE_PLAYFIELD_WIDTH);
+    clip->y1 = MIN(rect.y1, SNAKE_PLAYFIELD_HEIGHT);
+    if(clip->x0 >= clip->x1 || clip->y0 >= clip->y1) {
+        return false;
+    }
+    snake_playfield_box(
+        playfield, clip, clip->x0, clip->y0, clip->x1 - clip->x0, clip->y1 - clip->y0, false);
+    return true;
+}
+
+static void snake_playfield_frame(SnakePlayfield* const playfield, SnakeRect const* const clip) {
+    const int16_t w = SNAKE_PLAYFIELD_WIDTH;
+    const int16_t h = SNAKE_PLAYFIELD_HEIGHT;
+    snake_playfield_box(playfield, clip, 0, 0, w, 1, true);
+    snake_playfield_box(playfield, clip, 0, h - 1, w, 1, true);
+    snake_playfield_box(playfield, clip, 0, 0, 1, h, true);
+    snake_playfield_box(playfield, clip, w - 1, 0, 1, h, true);
+}
+
+static void snake_playfield_fruit(
+    SnakePlayfield* const playfield,
+    SnakeRect const* const clip,
+    Point const fruit,
+    bool core) {
+    SnakeRect f = snake_playfield_fruit_rect(fruit);
+    for(uint8_t row = 0; row < sizeof(fruit_sprite); row++) {
+        uint8_t bits = fruit_sprite[row];
+        if(core && (row == FRUIT_SPRITE_CORE_ROW || row == FRUIT_SPRITE_CORE_ROW + 1)) {
+            bits |= FRUIT_SPRITE_CORE;
+        }
+        for(uint8_t col = 0; col < FRUIT_SPRITE_WIDTH; col++) {
+            if(bits & (1 << col)) {
+                snake_playfield_pixel(playfield, clip, f.x0 + col, f.y0 + row, true);
+            }
+        }
+    }
+}
+
+// Cells under the clip, inclusive. The range is empty if the clip misses the board.
+static SnakeRect snake_playfield_cells(SnakeRect const* const clip) {
+    SnakeRect cells = {
+        .x0 = clip->x0 <= SNAKE_BOARD_X ? 0 : (clip->x0 - SNAKE_BOARD_X) / SNAKE_CELL_SIZE,
+        .y0 = clip->y0 <= SNAKE_BOARD_Y ? 0 : (clip->y0 - SNAKE_BOARD_Y) / SNAKE_CELL_SIZE,
+        .x1 = clip->x1 <= SNAKE_BOARD_X ?
+                  -1 :
+                  MIN((clip->x1 - 1 - SNAKE_BOARD_X) / SNAKE_CELL_SIZE, SNAKE_BOARD_WIDTH - 1),
+        .y1 = clip->y1 <= SNAKE_BOARD_Y ?
+                  -1 :
+                  MIN((clip->y1 - 1 - SNAKE_BOARD_Y) / SNAKE_CELL_SIZE, SNAKE_BOARD_HEIGHT - 1),
+    };
+    return cells;
+}
+
+// Every other pixel of a cell: walls, and CPU snakes in the arena
+static void snake_playfield_checker(
+    SnakePlayfield* const playfield,
+    SnakeRect const* const clip,
+    int16_t cx,
+    int16_t cy) {
+    for(int16_t py = CELL_Y(cy); py < CELL_Y(cy) + SNAKE_CELL_SIZE; py++) {
+        for(int16_t px = CELL_X(cx); px < CELL_X(cx) + SNAKE_CELL_SIZE; px++) {
+            if((px + py) % 2 == 0) {
+                snake_playfield_pixel(playfield, clip, px, py, true);
+            }
+        }
+    }
+}
+
+static void snake_playfield_head(
+    SnakePlayfield* const playfield,
+    SnakeRect const* const clip,
+    Point const head) {
+    snake_playfield_box(
+        playfield,
+        clip,
+        CELL_X(head.x) + HEAD_MARK_OFFSET,
+        CELL_Y(head.y) + HEAD_MARK_OFFSET,
+        HEAD_MARK_SIZE,
+        HEAD_MARK_SIZE,
+        false);
+}
+
+// Repaints everything that overlaps `rect`, in the same order the canvas used to be drawn:
+// frame, fruit, walls and snake, head
+static void snake_playfield_redraw(
+    SnakePlayfield* const playfield,
+    SnakeState const* const snake_state,
+    SnakeRect rect) {
+    SnakeRect clip;
+    if(!snake_playfield_clear(playfield, rect, &clip)) {
+        return;
+    }
+    snake_playfield_frame(playfield, &clip);
+    snake_playfield_fruit(playfield, &clip, snake_state->fruit, !snake_state->Endlessmode);
+
+    // Walls and snake, only the cells under the clip
+    SnakeRect cells = snake_playfield_cells(&clip);
+    for(int16_t cy = cells.y0; cy <= cells.y1; cy++) {
+        for(int16_t cx = cells.x0; cx <= cells.x1; cx++) {
+            Point p = {.x = cx, .y = cy};
+            if(snake_game_is_wall(snake_state, p)) {
+                snake_playfield_checker(playfield, &clip, cx, cy);
+            } else if(snake_game_is_occupied(snake_state, p)) {
+                snake_playfield_box(
+                    playfield,
+                    &clip,
+                    CELL_X(cx),
+                    CELL_Y(cy),
+                    SNAKE_CELL_SIZE,
+                    SNAKE_CELL_SIZE,
+                    true);
+            }
+        }
+    }
+
+    snake_playfield_head(playfield, &clip, snake_state->head_point);
+}
+
+// The arena's picture: the player's snake like in the classic game, CPU snakes checkered
+// with solid heads, the fruits always with their core
+static void snake_playfield_redraw_arena(
+    SnakePlayfield* const playfield,
+    SnakeArena const* const arena,
+    SnakeRect rect) {
+    SnakeRect clip;
+    if(!snake_playfield_clear(playfield, rect, &clip)) {
+        return;
+    }
+    snake_playfield_frame(playfield, &clip);
+    for(uint8_t f = 0; f < SNAKE_ARENA_FRUITS; f++) {
+        if(snake_arena_has_fruit(arena, f)) {
+            snake_playfield_fruit(playfield, &clip, arena->fruits[f], true);
+        }
+    }
+
+    SnakeRect cells = snake_playfield_cells(&clip);
+    for(int16_t cy = cells.y0; cy <= cells.y1; cy++) {
+        for(int16_t cx = cells.x0; cx <= cells.x1; cx++) {
+            Point p = {.x = cx, .y = cy};
+            uint8_t owner = snake_arena_owner(arena, p);
+            if(!owner) {
+                continue;
+            }
+            SnakeArenaSnake const* snake = &arena->snakes[owner - 1];
+            Point head = snake->points[snake->head];
+            if(owner - 1 == SNAKE_ARENA_PLAYER || (head.x == p.x && head.y == p.y)) {
+                snake_playfield_box(
+                    playfield,
+                    &clip,
+                    CELL_X(cx),
+                    CELL_Y(cy),
+                    SNAKE_CELL_SIZE,
+                    SNAKE_CELL_SIZE,
+                    true);
+                continue;
+            }
+            snake_playfield_checker(playfield, &clip, cx, cy);
+        }
+    }
+
+    SnakeArenaSnake const* player = &arena->snakes[SNAKE_ARENA_PLAYER];
+    if(player->alive) {
+        snake_playfield_head(playfield, &clip, player->points[player->head]);
+    }
+}
+
+void snake_playfield_draw(SnakePlayfield* const playfield, SnakeState const* const snake_state) {
+    SnakeRect all = {.x0 = 0, .y0 = 0, .x1 = SNAKE_PLAYFIELD_WIDTH, .y1 = SNAKE_PLAYFIELD_HEIGHT};
+    snake_playfield_redraw(playfield, snake_state, all);
+}
+
+bool snake_playfield_update(SnakePlayfield* const playfield, SnakeState const* const snake_state) {
+    SnakeStepChanges const* const changes = &snake_state->changes;
+
+    if(changes->moved) {
+        // New head plus the old one, which loses its marker
+        SnakeRect rect = snake_playfield_cell_rect(snake_state->head_point);
+        if(snake_state->len > 1) {
+            Point neck_point = snake_game_neighbour(
+                snake_state->head_point,
+                snake_game_body_direction(snake_state, snake_state->head));
+            SnakeRect neck = snake_playfield_cell_rect(neck_point);
+            rect.x0 = MIN(rect.x0, neck.x0);
+            rect.y0 = MIN(rect.y0, neck.y0);
+            rect.x1 = MAX(rect.x1, neck.x1);
+            rect.y1 = MAX(rect.y1, neck.y1);
+        }
+        snake_playfield_redraw(playfield, snake_state, rect);
+
+        if(!changes->grew) {
+            SnakeRect tail = snake_playfield_cell_rect(changes->tail);
+            snake_playfield_redraw(playfield, snake_state, tail);
+        }
+    }
+
+    if(changes->fruit_moved) {
+        snake_playfield_redraw(
+            playfield, snake_state, snake_playfield_fruit_rect(changes->old_fruit));
+        snake_playfield_redraw(
+            playfield, snake_state, snake_playfield_fruit_rect(snake_state->fruit));
+    }
+
+    return changes->moved || changes->fruit_moved;
+}
+
+void snake_playfield_draw_arena(SnakePlayfield* const playfield, SnakeArena const* const arena) {
+    SnakeRect all = {.x0 = 0, .y0 = 0, .x1 = SNAKE_PLAYFIELD_WIDTH, .y1 = SNAKE_PLAYFIELD_HEIGHT};
+    snake_playfield_redraw_arena(playfield, arena, all);
+}
+
+bool snake_playfield_update_arena(SnakePlayfield* const playfield, SnakeArena const* const arena) {
+    SnakeArenaChanges const* const changes = &arena->changes;
+    if(changes->all) {
+        // A whole body left the board, cheaper to repaint than to track
+        snake_playfield_draw_arena(playfield, arena);
+        return true;
+    }
+    for(uint8_t i = 0; i < changes->count; i++) {
+        snake_playfield_redraw_arena(
+            playfield, arena, snake_playfield_cell_rect(changes->cells[i]));
+    }
+    for(uint8_t f = 0; f < SNAKE_ARENA_FRUITS; f++) {
+        if(!(changes->fruits_moved & (1 << f))) {
+            continue;
+        }
+        // Either end may be off the board, waiting for a free cell
+        if(!snake_game_collision_with_frame(changes->old_fruits[f])) {
+            snake_playfield_redraw_arena(
+                playfield, arena, snake_playfield_fruit_rect(changes->old_fruits[f]));
+        }
+        if(snake_arena_has_fruit(arena, f)) {
+            snake_playfield_redraw_arena(
+                playfield, arena, snake_playfield_fruit_rect(arena->fruits[f]));
+        }
+    }
+    return changes->count || changes->fruits_moved;
+}
+
+static void snake_overlay_format_time(char* text, size_t size, const char* prefix, uint32_t s) {
+    snprintf(
+        text,
+        size,
+        "%s(%.2ld:%.2ld:%.2ld)",
+        prefix,
+        (long)(s / 60 / 60),
+        (long)(s / 60 % 60),
+        (long)(s % 60));
+}
+
+bool snake_overlay_update(SnakeOverlay* const overlay, SnakeState const* const snake_state) {
+    // Only shown while the clock stands, so the time played up to the stop is the time
+    uint32_t seconds = snake_state->clock.played_ms / 1000;
+    if(overlay->valid && !overlay->alive && overlay->len == snake_state->len &&
+       overlay->level == snake_state->level && overlay->seconds == seconds) {
+        return false;
+    }
+    overlay->len = snake_state->len;
+    overlay->alive = 0;
+    overlay->level = snake_state->level;
+    overlay->seconds = seconds;
+    overlay->valid = true;
+
+    if(snake_state->level) {
+        snprintf(overlay->pause, sizeof(overlay->pause), "Pause L%u", snake_state->level);
+    } else {
+        snprintf(overlay->pause, sizeof(overlay->pause), "Pause");
+    }
+    snprintf(overlay->score, sizeof(overlay->score), "Score: %u", snake_state->len - 7U);
+    char percent[16];
+    // The game is won with all open cells but one taken, it starts at 7
+    snprintf(
+        percent,
+        sizeof(percent),
+        "%-5.1f%% ",
+        (double)(snake_state->len - 7U) * 100 / (snake_state->open_cells - 1 - 7));
+    snake_overlay_format_time(overlay->progress, sizeof(overlay->progress), percent, seconds);
+    return true;
+}
+
+bool snake_overlay_update_arena(SnakeOverlay* const overlay, SnakeArena const* const arena) {
+    uint32_t seconds = arena->clock.played_ms / 1000;
+    uint16_t eaten = arena->snakes[SNAKE_ARENA_PLAYER].eaten;
+    uint8_t alive = snake_arena_alive(arena);
+    if(overlay->valid && overlay->alive == alive && overlay->len == eaten &&
+       overlay->seconds == seconds) {
+        return false;
+    }
+    overlay->len = eaten;
+    overlay->alive = alive;
+    overlay->level = 0;
+    overlay->seconds = seconds;
+    overlay->valid = true;
+
+    snprintf(overlay->pause, sizeof(overlay->pause), "Pause");
+    snprintf(overlay->score, sizeof(overlay->score), "Score: %u", eaten);
+    char left[16];
+    snprintf(left, sizeof(left), "%u left ", alive);
+    snake_overlay_format_time(overlay->progress, sizeof(overlay->progress), left, seconds);
+    return true;
+}
+
+bool snake_frame_capture(SnakeFrame* const frame, SnakeState const* const snake_state) {
+    bool won = snake_game_is_won(snake_state);
+    bool changed = frame->state != snake_state->state ||
+                   frame->Endlessmode != snake_state->Endlessmode || frame->arena ||
+                   frame->won != won || frame->len != snake_state->len;
+    frame->state = snake_state->state;
+    frame->Endlessmode = snake_state->Endlessmode;
+    frame->arena = false;
+    frame->won = won;
+    frame->len = snake_state->len;
+    if(frame->state == GameStatePause || frame->state == GameStateGameOver) {
+        changed |= snake_overlay_update(&frame->overlay, snake_state);
+    }
+    return changed;
+}
+
+bool snake_frame_capture_arena(SnakeFrame* const frame, SnakeArena const* const arena) {
+    uint16_t len = arena->snakes[SNAKE_ARENA_PLAYER].len;
+    bool changed = frame->state != arena->state || !frame->arena || frame->won != arena->won ||
+                   frame->len != len;
+    frame->state = arena->state;
+    frame->arena = true;
+    frame->won = arena->won;
+    frame->len = len;
+    if(frame->state == GameStatePause || frame->state == GameStateGameOver) {
+        changed |= snake_overlay_update_arena(&frame->overlay, arena);
+    }
+    return changed;
+}
+
+void snake_frame_latch_init(SnakeFrameLatch* const latch, SnakeFrame const* const frame) {
+    atomic_init(&latch->sequence, 0);
+    atomic_init(&latch->reads, 0);
+    atomic_init(&latch->retries, 0);
+    memcpy(&latch->frames[0], frame, sizeof(SnakeFrame));
+    memcpy(&latch->frames[1], frame, sizeof(SnakeFrame));
+}
+
+void snake_frame_publish(SnakeFrameLatch* const latch, SnakeFrame const* const frame) {
+    // An odd sequence sends readers to frames[1] while frames[0] is written, an even one back
+    unsigned sequence = atomic_load_explicit(&latch->sequence, memory_order_relaxed);
+
+    // The fences keep every counter update between the writes of the two copies
+    atomic_store_explicit(&latch->sequence, sequence + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    memcpy(&latch->frames[0], frame, sizeof(SnakeFrame));
+
+    atomic_thread_fence(memory_order_release);
+    atomic_store_explicit(&latch->sequence, sequence + 2, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    memcpy(&latch->frames[1], frame, sizeof(SnakeFrame));
+}
+
+void snake_frame_read(SnakeFrameLatch* const latch, SnakeFrame* const frame) {
+    atomic_fetch_add_explicit(&latch->reads, 1, memory_order_relaxed);
+    for(;;) {
+        unsigned sequence = atomic_load_explicit(&latch->sequence, memory_order_acquire);
+        memcpy(frame, &latch->frames[sequence & 1], sizeof(SnakeFrame));
+        atomic_thread_fence(memory_order_acquire);
+        if(atomic_load_explicit(&latch->sequence, memory_order_relaxed) == sequence) {
+            return;
+        }
+        // The writer switched copies under us, the one we read may be torn
+        atomic_fetch_add_explicit(&latch->retries, 1, memory_order_relaxed);
+    }
+}
+
+void snake_game_render(Canvas* const canvas, SnakeFrame const* const frame) {
+    // Before the function is called, the state is set with the canvas_reset(canvas)
+    SnakeOverlay const* const overlay = &frame->overlay;
+
+    // Frame, fruit and snake are kept up to date in the playfield by the game loop
+    canvas_draw_xbm(
+        canvas, 0, 0, SNAKE_PLAYFIELD_WIDTH, SNAKE_PLAYFIELD_HEIGHT, frame->playfield.bits);
+
+    // Pause and GameOver banner
+    if(frame->state == GameStatePause || frame->state == GameStateGameOver) {
+        // Screen is 128x64 px
+        canvas_set_color(canvas, ColorWhite);
+        canvas_draw_box(canvas, 33, 23, 64, 26);
+
+        canvas_set_color(canvas, ColorBlack);
+        canvas_draw_frame(canvas, 34, 24, 62, 24);
+
+        canvas_set_font(canvas, FontPrimary);
+        if(frame->state == GameStateGameOver) {
+            if(frame->won) {
+                canvas_draw_str_aligned(canvas, 65, 35, AlignCenter, AlignBottom, "You WON!");
+            } else {
+                canvas_draw_str_aligned(canvas, 65, 35, AlignCenter, AlignBottom, "Game Over");
+            }
+        }
+        if(frame->state == GameStatePause) {
+            canvas_draw_str_aligned(canvas, 65, 35, AlignCenter, AlignBottom, overlay->pause);
+        }
+
+        canvas_set_font(canvas, FontSecondary);
+        canvas_draw_str_aligned(canvas, 65, 45, AlignCenter, AlignBottom, overlay->score);
+
+        // Painting "back"-symbol, Help message for Exit App, ProgressBar (Complete %)
+        canvas_set_color(canvas, ColorWhite);
+        canvas_draw_box(canvas, 22, 1, 87, 22);
+        canvas_draw_box(canvas, 24, 54, 83, 9);
+        canvas_set_color(canvas, ColorBlack);
+        canvas_draw_str_aligned(
+            canvas, 65, 10, AlignCenter, AlignBottom, "Hold        to Exit App");
+        //Endless mode ON/OFF, or the arena, which the arrows leave
+        if(frame->arena) {
+            canvas_draw_str_aligned(canvas, 24, 21, AlignLeft, AlignBottom, "Arena mode");
+            canvas_draw_str_aligned(canvas, 89, 21, AlignLeft, AlignBottom, "ON");
+        } else if(frame->Endlessmode == false) {
+            canvas_draw_str_aligned(canvas, 24, 21, AlignLeft, AlignBottom, "Endless mode   OFF");
+        } else {
+            canvas_draw_str_aligned(canvas, 24, 21, AlignLeft, AlignBottom, "Endless mode");
+            canvas_draw_str_aligned(canvas, 89, 21, AlignLeft, AlignBottom, "ON");
+        }
+
+        canvas_draw_str_aligned(canvas, 65, 62, AlignCenter, AlignBottom, overlay->progress);
+
+        canvas_draw_icon(canvas, x_back_symbol, y_back_symbol, &I_back_10x8);
+        canvas_draw_icon(canvas, x_arrow_left, y_arrow_left, &I_arrow_left_4x7);
+        canvas_draw_icon(canvas, x_arrow_right, y_arrow_right, &I_arrow_right_4x7);
+    } else if(frame->debug.lines) {
+        // 9 px per line, stacked up from the bottom edge
+        int32_t top = SNAKE_PLAYFIELD_HEIGHT - 1 - 9 * frame->debug.lines;
+        canvas_set_color(canvas, ColorWhite);
+        canvas_draw_box(canvas, 0, top, SNAKE_PLAYFIELD_WIDTH, SNAKE_PLAYFIELD_HEIGHT - top);
+        canvas_set_color(canvas, ColorBlack);
+        canvas_set_font(canvas, FontSecondary);
+        for(uint8_t i = 0; i < frame->debug.lines; i++) {
+            canvas_draw_str_aligned(
+                canvas, 1, top + 9 * (i + 1), AlignLeft, AlignBottom, frame->debug.text[i]);
+        }
+    }
+}
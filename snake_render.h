@@ -0,0 +1,109 @@
+#pragma once
+
+// Drawing of the playfield and the pause/game over screens.
+// Only the public Canvas API is used, so the host build can render into a stub canvas.
+
+#include <gui/canvas.h>
+#include <stdatomic.h>
+
+#include "snake_arena.h"
+#include "snake_game.h"
+
+#define SNAKE_PLAYFIELD_WIDTH 128
+#define SNAKE_PLAYFIELD_HEIGHT 64
+
+// Pixels per cell side. The board is centered inside the 1 px frame around the screen.
+#ifdef SNAKE_BIG_BOARD
+#define SNAKE_CELL_SIZE 2
+#else
+#define SNAKE_CELL_SIZE 4
+#endif
+#define SNAKE_BOARD_X ((SNAKE_PLAYFIELD_WIDTH - SNAKE_BOARD_WIDTH * SNAKE_CELL_SIZE) / 2)
+#define SNAKE_BOARD_Y ((SNAKE_PLAYFIELD_HEIGHT - SNAKE_BOARD_HEIGHT * SNAKE_CELL_SIZE) / 2)
+
+_Static_assert(
+    SNAKE_BOARD_X >= 1 && SNAKE_BOARD_Y >= 1,
+    "the board doesn't fit inside the frame");
+
+// 1-bpp XBM image of the frame, the fruit and the snake.
+// It is kept in sync with the game state by the game loop, so drawing a frame is one blit.
+typedef struct {
+    uint8_t bits[SNAKE_PLAYFIELD_WIDTH / 8 * SNAKE_PLAYFIELD_HEIGHT];
+} SnakePlayfield;
+
+// Repaints the whole playfield: after a new game, a load or an Endless mode switch
+void snake_playfield_draw(SnakePlayfield* const playfield, SnakeState const* const snake_state);
+
+// Repaints only what the last game step touched (snake_state->changes).
+// Returns false if the step left the picture as it was.
+bool snake_playfield_update(SnakePlayfield* const playfield, SnakeState const* const snake_state);
+
+// The same two for the arena, the update goes by arena->changes
+void snake_playfield_draw_arena(SnakePlayfield* const playfield, SnakeArena const* const arena);
+bool snake_playfield_update_arena(SnakePlayfield* const playfield, SnakeArena const* const arena);
+
+// Numbers of the pause/game over screen, formatted only when they change
+typedef struct {
+    bool valid;
+    uint16_t len; // fruits eaten in the arena
+    uint8_t alive; // snakes left in the arena
+    uint8_t level;
+    uint32_t seconds;
+    char pause[16]; // the title while paused, with the level
+    char score[16];
+    char progress[32];
+} SnakeOverlay;
+
+// Refreshes the overlay text, cheap to call when nothing changed.
+// Returns true if the text is different now.
+bool snake_overlay_update(SnakeOverlay* const overlay, SnakeState const* const snake_state);
+bool snake_overlay_update_arena(SnakeOverlay* const overlay, SnakeArena const* const arena);
+
+#define SNAKE_DEBUG_LINES 7 // the whole screen
+
+// Diagnostics over the bottom of the playfield while the game runs, the game loop
+// formats the text
+typedef struct {
+    uint8_t lines; // 0 hides the overlay
+    char text[SNAKE_DEBUG_LINES][32];
+} SnakeDebugOverlay;
+
+// Everything a frame is drawn from. The game loop owns one and keeps it current,
+// the GUI thread only ever sees published copies of it, never the SnakeState.
+typedef struct {
+    GameState state;
+    bool Endlessmode;
+    bool arena; // the arena is played, Endlessmode doesn't apply
+    bool won;
+    uint16_t len;
+    SnakePlayfield playfield;
+    SnakeOverlay overlay;
+    SnakeDebugOverlay debug;
+} SnakeFrame;
+
+// Copies what the renderer needs from the state, the playfield is updated separately.
+// Returns true if any of it differs from what the frame showed before.
+bool snake_frame_capture(SnakeFrame* const frame, SnakeState const* const snake_state);
+bool snake_frame_capture_arena(SnakeFrame* const frame, SnakeArena const* const arena);
+
+// Lock-free handoff of frames from the game loop to the GUI thread.
+// Two copies ordered by a sequence counter: the writer updates them one after the
+// other and the reader always copies the one that isn't being written, so neither
+// side ever waits. A read is retried only if a publish overlapped it.
+typedef struct {
+    atomic_uint sequence;
+    SnakeFrame frames[2];
+    atomic_uint reads;
+    atomic_uint retries;
+} SnakeFrameLatch;
+
+void snake_frame_latch_init(SnakeFrameLatch* const latch, SnakeFrame const* const frame);
+
+// Single writer: the game loop
+void snake_frame_publish(SnakeFrameLatch* const latch, SnakeFrame const* const frame);
+
+// Any number of readers, copies the latest published frame into `frame`
+void snake_frame_read(SnakeFrameLatch* const latch, SnakeFrame* const frame);
+
+// Draws the playfield and the pause/game over screen onto a freshly reset canvas
+void snake_game_render(Canvas* const canvas, SnakeFrame const* const frame);
@@ -0,0 +1,136 @@
+#include "snake_rewind.h"
+
+#include <string.h>
+
+// Step record, byte 0: movement before the step (bits 0-1), nextMovement (bits 2-3),
+// state (bits 4-5), the head moved, the snake grew.
+// Byte 1: the cell the tail left, from the tail after the step (bits 0-1), a fruit was eaten.
+#define SNAKE_REWIND_MOVED (1 << 6)
+#define SNAKE_REWIND_GREW (1 << 7)
+#define SNAKE_REWIND_EATEN (1 << 2)
+
+void snake_rewind_reset(SnakeRewind* const rewind) {
+    rewind->step_first = 0;
+    rewind->step_count = 0;
+    rewind->eat_first = 0;
+    rewind->eat_count = 0;
+}
+
+static void snake_rewind_forget_oldest(SnakeRewind* const rewind) {
+    if(rewind->steps[rewind->step_first][1] & SNAKE_REWIND_EATEN) {
+        // The oldest fruit eaten belongs to the oldest step that ate one
+        rewind->eat_first = (rewind->eat_first + 1) % SNAKE_REWIND_EATS;
+        rewind->eat_count--;
+    }
+    rewind->step_first = (rewind->step_first + 1) % SNAKE_REWIND_STEPS;
+    rewind->step_count--;
+}
+
+void snake_rewind_step(
+    SnakeRewind* const rewind,
+    SnakeState* const snake_state,
+    SnakePlatform const* const platform) {
+    if(snake_state->state == GameStateGameOver) {
+        // Nothing happens, nothing to undo
+        snake_game_process_game_step(snake_state, platform);
+        return;
+    }
+
+    uint8_t record[2] = {
+        snake_state->currentMovement | snake_state->nextMovement << 2 | snake_state->state << 4,
+        0,
+    };
+    uint32_t rng = snake_state->rng;
+    Point fruit = snake_state->fruit;
+    uint16_t len = snake_state->len;
+
+    snake_game_process_game_step(snake_state, platform);
+
+    SnakeStepChanges const* const changes = &snake_state->changes;
+    if(changes->moved) {
+        record[0] |= SNAKE_REWIND_MOVED;
+    }
+    // Not changes->grew: the winning fruit makes the snake longer without a move
+    if(snake_state->len != len) {
+        record[0] |= SNAKE_REWIND_GREW;
+    } else if(changes->moved) {
+        record[1] = snake_game_direction(snake_state->tail_point, changes->tail);
+    }
+
+    if(changes->fruit_moved) {
+        while(rewind->eat_count == SNAKE_REWIND_EATS) {
+            snake_rewind_forget_oldest(rewind);
+        }
+        uint16_t eat = (rewind->eat_first + rewind->eat_count++) % SNAKE_REWIND_EATS;
+        rewind->eats[eat] = (SnakeRewindEat){.rng = rng, .fruit = fruit};
+        record[1] |= SNAKE_REWIND_EATEN;
+    }
+
+    if(rewind->step_count == SNAKE_REWIND_STEPS) {
+        snake_rewind_forget_oldest(rewind);
+    }
+    uint16_t step = (rewind->step_first + rewind->step_count++) % SNAKE_REWIND_STEPS;
+    memcpy(rewind->steps[step], record, sizeof(record));
+}
+
+uint16_t snake_rewind_back(
+    SnakeRewind* const rewind,
+    SnakeState* const snake_state,
+    uint16_t steps) {
+    uint16_t undone = 0;
+    bool valid = true;
+    for(; undone < steps && rewind->step_count; undone++) {
+        uint16_t step = (rewind->step_first + --rewind->step_count) % SNAKE_REWIND_STEPS;
+        uint8_t const* const record = rewind->steps[step];
+
+        if(record[1] & SNAKE_REWIND_EATEN) {
+            uint16_t eat = (rewind->eat_first + --rewind->eat_count) % SNAKE_REWIND_EATS;
+            snake_state->rng = rewind->eats[eat].rng;
+            snake_state->fruit = rewind->eats[eat].fruit;
+        }
+
+        bool grew = record[0] & SNAKE_REWIND_GREW;
+        if(grew && snake_state->len < 2) {
+            valid = false;
+            break;
+        }
+        if(record[0] & SNAKE_REWIND_MOVED) {
+            Point tail = {0};
+            if(!grew) {
+                // The cell the tail comes back to has to be open and free, or the record
+                // isn't about this game
+                tail = snake_game_neighbour(snake_state->tail_point, record[1] & 3);
+                if(snake_game_collision_with_walls(snake_state, tail) ||
+                   snake_game_is_occupied(snake_state, tail)) {
+                    valid = false;
+                    break;
+                }
+            }
+            snake_game_unmove_snake(snake_state, tail, grew);
+        }
+        if(grew) {
+            snake_state->len--;
+        }
+
+        snake_state->currentMovement = record[0] & 3;
+        snake_state->nextMovement = (record[0] >> 2) & 3;
+        snake_state->state = (record[0] >> 4) & 3;
+        snake_state->steps--;
+    }
+    if(valid && !undone) {
+        return 0;
+    }
+    // Every undone move kept the bitmap, the free counts and the tail up to date, there is
+    // nothing to rebuild. A record that doesn't match the game shows up as a body that no
+    // longer adds up, and then none of them can be trusted.
+    if(!valid || snake_state->free_count + snake_state->len != snake_state->open_cells ||
+       !snake_game_is_occupied(snake_state, snake_state->head_point) ||
+       snake_game_collision_with_walls(snake_state, snake_state->fruit)) {
+        snake_rewind_reset(rewind);
+        return 0;
+    }
+
+    memset(&snake_state->changes, 0, sizeof(snake_state->changes));
+    snake_state->turn_count = 0;
+    return undone;
+}
@@ -0,0 +1,56 @@
+#pragma once
+
+// Stepping a game back after a crash.
+//
+// Every step the app plays through snake_rewind_step leaves a 2 byte record in a ring:
+// the movement and the state before the step, whether the head moved and whether the
+// tail stayed, and where the tail was, as a direction from the new tail.
+// The fruit and the random generator only change when a fruit is eaten, those steps
+// also leave the old fruit and generator state in a second, smaller ring. When either
+// ring is full the oldest steps are forgotten. Taking one step back costs the same
+// whatever the length of the snake, the size of the board or the number of steps kept:
+// it undoes the move on the bitmap and the free counts like a step does it, nothing is
+// rebuilt.
+
+#include "snake_game.h"
+
+// Steps kept, 4 a second at the normal speed
+#ifndef SNAKE_REWIND_STEPS
+#define SNAKE_REWIND_STEPS 256
+#endif
+// Eaten fruits kept among them, more steps are forgotten past this many
+#define SNAKE_REWIND_EATS (SNAKE_REWIND_STEPS / 4)
+
+typedef struct {
+    uint32_t rng;
+    Point fruit;
+} SnakeRewindEat;
+
+typedef struct {
+    uint8_t steps[SNAKE_REWIND_STEPS][2];
+    uint16_t step_first; // the oldest record
+    uint16_t step_count;
+    SnakeRewindEat eats[SNAKE_REWIND_EATS];
+    uint16_t eat_first;
+    uint16_t eat_count;
+} SnakeRewind;
+
+// Forgets every step, for a new game, a load or a replay
+void snake_rewind_reset(SnakeRewind* const rewind);
+
+// Plays one step like snake_game_process_game_step and keeps what it takes to undo it
+void snake_rewind_step(
+    SnakeRewind* const rewind,
+    SnakeState* const snake_state,
+    SnakePlatform const* const platform);
+
+// Undoes up to `steps` of the last steps, returns how many were undone. Like a load it
+// keeps nextMovement but drops the turns queued behind it, and the clock is left alone,
+// the caller pauses the game. Each undone step is checked in constant time against the
+// game: the tail has to come back to a free open cell and the body has to add up with the
+// free cells. Returns 0 if a record doesn't match: the state is broken then and every step
+// is forgotten, keep a copy to go back to.
+uint16_t snake_rewind_back(
+    SnakeRewind* const rewind,
+    SnakeState* const snake_state,
+    uint16_t steps);
@@ -0,0 +1,134 @@
+#include "snake_save.h"
+
+#include <string.h>
+
+static const uint8_t snake_save_magic[4] = {'S', 'N', 'K', '2'};
+
+// CRC-32/ISO-HDLC four bits at a time: 64 bytes of table instead of 1 KB
+static const uint32_t snake_save_crc_table[16] = {
+    0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+    0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C,
+};
+
+uint32_t snake_save_crc32(const uint8_t* data, size_t size) {
+    uint32_t crc = 0xFFFFFFFF;
+    for(size_t i = 0; i < size; i++) {
+        crc ^= data[i];
+        crc = (crc >> 4) ^ snake_save_crc_table[crc & 0x0F];
+        crc = (crc >> 4) ^ snake_save_crc_table[crc & 0x0F];
+    }
+    return ~crc;
+}
+
+size_t snake_save_encode(SnakeState const* const snake_state, uint8_t* buffer, size_t size) {
+    uint16_t len = snake_state->len;
+    size_t body_size = (len - 1 + 3) / 4;
+    size_t payload_size = SNAKE_SAVE_FIXED_SIZE + body_size + SNAKE_SAVE_EXTRA_SIZE;
+    if(!len || SNAKE_SAVE_HEADER_SIZE + payload_size > size) {
+        return 0;
+    }
+
+    uint8_t* payload = buffer + SNAKE_SAVE_HEADER_SIZE;
+    Point head = snake_state->head_point;
+    snake_save_put_u16(&payload[0], len);
+    payload[2] = head.x;
+    payload[3] = head.y;
+    payload[4] = snake_state->fruit.x;
+    payload[5] = snake_state->fruit.y;
+    payload[6] = snake_state->currentMovement;
+    payload[7] = snake_state->nextMovement;
+    payload[8] = snake_state->state;
+    payload[9] = snake_state->Endlessmode ? 1 : 0;
+    snake_save_put_u32(&payload[10], snake_state->clock.played_ms / 1000);
+    payload[14] = SNAKE_BOARD_WIDTH;
+    payload[15] = SNAKE_BOARD_HEIGHT;
+
+    uint8_t* body = payload + SNAKE_SAVE_FIXED_SIZE;
+    memset(body, 0, body_size);
+    // The same directions as the state's ring, starting from the head
+    uint16_t idx = snake_state->head;
+    for(uint16_t i = 0; i + 1 < len; i++) {
+        body[i / 4] |= snake_game_body_direction(snake_state, idx) << (i % 4 * 2);
+        idx = snake_game_next_index(idx);
+    }
+
+    uint8_t* extra = body + body_size;
+    snake_save_put_u32(&extra[0], snake_state->rng);
+    snake_save_put_u32(&extra[4], snake_state->steps);
+    snake_save_put_u32(&extra[8], snake_state->clock.played_ms);
+    extra[12] = snake_state->level;
+
+    memcpy(buffer, snake_save_magic, sizeof(snake_save_magic));
+    buffer[4] = SNAKE_SAVE_VERSION_MAJOR;
+    buffer[5] = SNAKE_SAVE_VERSION_MINOR;
+    snake_save_put_u16(&buffer[6], payload_size);
+    snake_save_put_u32(&buffer[8], snake_save_crc32(payload, payload_size));
+
+    return SNAKE_SAVE_HEADER_SIZE + payload_size;
+}
+
+bool snake_save_decode(SnakeState* const snake_state, const uint8_t* buffer, size_t size) {
+    if(size < SNAKE_SAVE_HEADER_SIZE ||
+       memcmp(buffer, snake_save_magic, sizeof(snake_save_magic)) != 0 ||
+       buffer[4] != SNAKE_SAVE_VERSION_MAJOR) {
+        return false;
+    }
+
+    size_t payload_size = snake_save_get_u16(&buffer[6]);
+    const uint8_t* payload = buffer + SNAKE_SAVE_HEADER_SIZE;
+    if(SNAKE_SAVE_HEADER_SIZE + payload_size > size || payload_size < SNAKE_SAVE_FIXED_SIZE ||
+       snake_save_crc32(payload, payload_size) != snake_save_get_u32(&buffer[8])) {
+        return false;
+    }
+
+    uint16_t len = snake_save_get_u16(&payload[0]);
+    size_t body_size = (len - 1 + 3) / 4;
+    if(!len || len >= MAX_SNAKE_LEN || payload_size < SNAKE_SAVE_FIXED_SIZE + body_size) {
+        return false;
+    }
+    // A game of another board size can't be continued here
+    bool classic = !payload[14] && !payload[15];
+    uint8_t width = classic ? 31 : payload[14];
+    uint8_t height = classic ? 15 : payload[15];
+    if(width != SNAKE_BOARD_WIDTH || height != SNAKE_BOARD_HEIGHT) {
+        return false;
+    }
+
+    snake_state->len = len;
+    snake_state->head = 0;
+    snake_state->head_point.x = payload[2];
+    snake_state->head_point.y = payload[3];
+    snake_state->fruit.x = payload[4];
+    snake_state->fruit.y = payload[5];
+    snake_state->currentMovement = payload[6];
+    snake_state->nextMovement = payload[7];
+    snake_state->state = payload[8];
+    snake_state->Endlessmode = payload[9] & 1;
+    snake_clock_reset(&snake_state->clock);
+    snake_state->clock.played_ms = snake_save_get_u32(&payload[10]) * 1000;
+    memset(&snake_state->changes, 0, sizeof(snake_state->changes));
+
+    const uint8_t* body = payload + SNAKE_SAVE_FIXED_SIZE;
+    for(uint16_t i = 0; i + 1 < len; i++) {
+        Direction direction = (body[i / 4] >> (i % 4 * 2)) & 3;
+        snake_game_set_body_direction(snake_state, i, direction);
+    }
+
+    const uint8_t* extra = body + body_size;
+    size_t extra_size = payload_size - SNAKE_SAVE_FIXED_SIZE - body_size;
+    if(extra_size >= SNAKE_SAVE_EXTRA_V1_1_SIZE) {
+        snake_state->rng = snake_save_get_u32(&extra[0]);
+        snake_state->steps = snake_save_get_u32(&extra[4]);
+    } else {
+        // v1.0 didn't have them, any seed will do
+        snake_state->rng = 0x2545F491;
+        snake_state->steps = 0;
+    }
+    if(extra_size >= SNAKE_SAVE_EXTRA_V1_2_SIZE) {
+        snake_state->clock.played_ms = snake_save_get_u32(&extra[8]);
+    }
+    snake_state->level = extra_size >= SNAKE_SAVE_EXTRA_SIZE ? extra[12] : 0;
+
+    // Range checks of every field, the level, the board and the free set
+    return snake_game_restore(snake_state);
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+// Save file format of Snake 2.0, independent of the SnakeState layout.
+//
+// Header, 12 bytes, little endian:
+//   "SNK2" magic, major version, minor version, payload size (u16), CRC-32 of the payload
+// Payload v1.0:
+//   len (u16), head x/y, fruit x/y, current/next direction, state, flags (bit 0 Endless mode),
+//   stopped timer seconds (u32), then the direction from every body point to the next one
+//   towards the tail, 2 bits each, four to a byte starting at the low bits.
+// Added in v1.1, after the body:
+//   random generator state (u32), steps played (u32)
+// Added in v1.2:
+//   play time in milliseconds (u32), the seconds field above still holds it rounded down
+// Since v1.3 the two reserved bytes after the seconds hold the board width and height,
+// zero in older saves means the classic 31x15 board
+// Added in v1.4:
+//   level (u8), older saves are on the plain board
+//
+// A reader accepts any minor version of its major one: newer minors only append to the
+// payload, and what it doesn't know is skipped. A new major means an incompatible layout.
+
+#include "snake_game.h"
+
+#define SNAKE_SAVE_VERSION_MAJOR 1
+#define SNAKE_SAVE_VERSION_MINOR 4
+
+#define SNAKE_SAVE_HEADER_SIZE 12
+#define SNAKE_SAVE_FIXED_SIZE 16
+#define SNAKE_SAVE_EXTRA_V1_1_SIZE 8
+#define SNAKE_SAVE_EXTRA_V1_2_SIZE 12
+#define SNAKE_SAVE_EXTRA_SIZE 13 // v1.4
+#define SNAKE_SAVE_MAX_SIZE                                                       \
+    (SNAKE_SAVE_HEADER_SIZE + SNAKE_SAVE_FIXED_SIZE + (MAX_SNAKE_LEN - 1 + 3) / 4 + \
+     SNAKE_SAVE_EXTRA_SIZE)
+
+// Little endian fields, shared with the replay format
+
+static inline void snake_save_put_u16(uint8_t* p, uint16_t value) {
+    p[0] = value;
+    p[1] = value >> 8;
+}
+
+static inline void snake_save_put_u32(uint8_t* p, uint32_t value) {
+    p[0] = value;
+    p[1] = value >> 8;
+    p[2] = value >> 16;
+    p[3] = value >> 24;
+}
+
+static inline uint16_t snake_save_get_u16(const uint8_t* p) {
+    return p[0] | (p[1] << 8);
+}
+
+static inline uint32_t snake_save_get_u32(const uint8_t* p) {
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+// Writes the state into `buffer`, returns the number of bytes used or 0 if it doesn't fit
+size_t snake_save_encode(SnakeState const* const snake_state, uint8_t* buffer, size_t size);
+
+// Reads a save into `snake_state` and rebuilds what is derived from the body.
+// Returns false for anything that isn't an intact save of a valid game,
+// `snake_state` is undefined then.
+bool snake_save_decode(SnakeState* const snake_state, const uint8_t* buffer, size_t size);
+
+uint32_t snake_save_crc32(const uint8_t* data, size_t size);
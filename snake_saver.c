@@ -0,0 +1,228 @@
+#include "snake_saver.h"
+
+#include <furi.h>
+#include <storage/storage.h>
+
+#include "snake_profile.h"
+#include "snake_save.h"
+
+#define TAG "SnakeSaver"
+
+#define SAVING_FILENAME APP_DATA_PATH("snake2.save")
+#define SAVING_TMP_FILENAME APP_DATA_PATH("snake2.save.tmp")
+#define REPLAY_FILENAME APP_DATA_PATH("snake2.replay")
+#define REPLAY_TMP_FILENAME APP_DATA_PATH("snake2.replay.tmp")
+#define PROFILE_FILENAME APP_DATA_PATH("snake2.profile.txt")
+#define PROFILE_TMP_FILENAME APP_DATA_PATH("snake2.profile.txt.tmp")
+
+typedef enum {
+    SnakeSaverFlagSave = 1 << 0,
+    SnakeSaverFlagExit = 1 << 1,
+} SnakeSaverFlag;
+
+#define SNAKE_SAVER_FLAGS (SnakeSaverFlagSave | SnakeSaverFlagExit)
+
+// A whole file waiting to be written, owned by the saver
+typedef struct {
+    uint8_t* data; // NULL if nothing is pending
+    size_t size;
+} SnakeSaverBlob;
+
+struct SnakeSaver {
+    FuriThread* thread;
+    FuriMutex* mutex; // guards the pending snapshot
+    uint8_t pending[SNAKE_SAVE_MAX_SIZE];
+    size_t pending_size; // 0 if nothing is waiting
+    uint8_t writing[SNAKE_SAVE_MAX_SIZE]; // worker's copy, requests may come in meanwhile
+    SnakeSaverBlob replay;
+    SnakeSaverBlob profile;
+    uint32_t requests;
+    uint32_t writes;
+};
+
+static bool snake_saver_write(
+    Storage* storage,
+    const char* path,
+    const char* tmp_path,
+    const uint8_t* buffer,
+    size_t size) {
+    File* file = storage_file_alloc(storage);
+    bool written = storage_file_open(file, tmp_path, FSAM_WRITE, FSOM_CREATE_ALWAYS) &&
+                   storage_file_write(file, buffer, size) == size;
+    storage_file_close(file);
+    storage_file_free(file);
+
+    if(written) {
+        // Rename doesn't replace on every firmware. Until it is done the new save
+        // is the temporary file, which snake_saver_load looks at first.
+        storage_common_remove(storage, path);
+        written = storage_common_rename(storage, tmp_path, path) == FSE_OK;
+    }
+    return written;
+}
+
+static int32_t snake_saver_worker(void* ctx) {
+    SnakeSaver* saver = ctx;
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+
+    for(bool running = true; running;) {
+        uint32_t flags =
+            furi_thread_flags_wait(SNAKE_SAVER_FLAGS, FuriFlagWaitAny, FuriWaitForever);
+        if(flags & FuriFlagError) {
+            continue;
+        }
+        // A save requested together with the exit is still written
+        running = !(flags & SnakeSaverFlagExit);
+
+        furi_mutex_acquire(saver->mutex, FuriWaitForever);
+        size_t size = saver->pending_size;
+        memcpy(saver->writing, saver->pending, size);
+        saver->pending_size = 0;
+        SnakeSaverBlob replay = saver->replay;
+        saver->replay.data = NULL;
+        SnakeSaverBlob profile = saver->profile;
+        saver->profile.data = NULL;
+        furi_mutex_release(saver->mutex);
+
+        if(size) {
+            SNAKE_PROFILE_BEGIN(SnakeProfileSave);
+            if(!snake_saver_write(
+                   storage, SAVING_FILENAME, SAVING_TMP_FILENAME, saver->writing, size)) {
+                FURI_LOG_E(TAG, "cannot write the save file");
+            }
+            SNAKE_PROFILE_END(SnakeProfileSave);
+            saver->writes++;
+        }
+        if(replay.data) {
+            if(!snake_saver_write(
+                   storage, REPLAY_FILENAME, REPLAY_TMP_FILENAME, replay.data, replay.size)) {
+                FURI_LOG_E(TAG, "cannot write the replay file");
+            }
+            free(replay.data);
+        }
+        if(profile.data) {
+            if(!snake_saver_write(
+                   storage, PROFILE_FILENAME, PROFILE_TMP_FILENAME, profile.data, profile.size)) {
+                FURI_LOG_E(TAG, "cannot write the profile report");
+            }
+            free(profile.data);
+        }
+    }
+
+    furi_record_close(RECORD_STORAGE);
+    return 0;
+}
+
+SnakeSaver* snake_saver_alloc(void) {
+    SnakeSaver* saver = malloc(sizeof(SnakeSaver));
+    saver->mutex = furi_mutex_alloc(FuriMutexTypeNormal);
+    saver->pending_size = 0;
+    saver->replay.data = NULL;
+    saver->profile.data = NULL;
+    saver->requests = 0;
+    saver->writes = 0;
+    saver->thread = furi_thread_alloc_ex("SnakeSaver", 1024, snake_saver_worker, saver);
+    furi_thread_start(saver->thread);
+    return saver;
+}
+
+void snake_saver_free(SnakeSaver* saver) {
+    furi_thread_flags_set(furi_thread_get_id(saver->thread), SnakeSaverFlagExit);
+    furi_thread_join(saver->thread);
+    furi_thread_free(saver->thread);
+    furi_mutex_free(saver->mutex);
+    free(saver->replay.data);
+    free(saver->profile.data);
+    FURI_LOG_I(TAG, "save requests: %lu, writes: %lu", saver->requests, saver->writes);
+    free(saver);
+}
+
+void snake_saver_request(SnakeSaver* saver, SnakeState const* const snake_state) {
+    furi_mutex_acquire(saver->mutex, FuriWaitForever);
+    saver->pending_size = snake_save_encode(snake_state, saver->pending, sizeof(saver->pending));
+    saver->requests++;
+    furi_mutex_release(saver->mutex);
+
+    furi_thread_flags_set(furi_thread_get_id(saver->thread), SnakeSaverFlagSave);
+}
+
+static void snake_saver_request_blob(
+    SnakeSaver* saver,
+    SnakeSaverBlob* blob,
+    const uint8_t* data,
+    size_t size) {
+    uint8_t* copy = malloc(size);
+    memcpy(copy, data, size);
+
+    furi_mutex_acquire(saver->mutex, FuriWaitForever);
+    // Only the newest one is kept, one the worker hasn't got to is dropped
+    free(blob->data);
+    blob->data = copy;
+    blob->size = size;
+    furi_mutex_release(saver->mutex);
+
+    furi_thread_flags_set(furi_thread_get_id(saver->thread), SnakeSaverFlagSave);
+}
+
+void snake_saver_request_replay(SnakeSaver* saver, const uint8_t* data, size_t size) {
+    snake_saver_request_blob(saver, &saver->replay, data, size);
+}
+
+#ifdef SNAKE_PROFILE
+void snake_saver_request_profile(SnakeSaver* saver, const char* text, size_t size) {
+    snake_saver_request_blob(saver, &saver->profile, (const uint8_t*)text, size);
+}
+#endif
+
+static bool snake_saver_read(Storage* storage, const char* path, SnakeState* const snake_state) {
+    File* file = storage_file_alloc(storage);
+    bool loaded = false;
+    if(storage_file_open(file, path, FSAM_READ, FSOM_OPEN_EXISTING)) {
+        // Newer minor versions of the format may be longer than what this build writes
+        uint64_t size = storage_file_size(file);
+        if(size <= SNAKE_SAVE_MAX_SIZE * 4) {
+            uint8_t* buffer = malloc(size);
+            if(storage_file_read(file, buffer, size) == size) {
+                loaded = snake_save_decode(snake_state, buffer, size);
+            }
+            free(buffer);
+        }
+        if(!loaded) {
+            FURI_LOG_W(TAG, "%s is corrupt or unsupported", path);
+        }
+    }
+    storage_file_close(file);
+    storage_file_free(file);
+    return loaded;
+}
+
+bool snake_saver_load(SnakeState* const snake_state) {
+    SNAKE_PROFILE_BEGIN(SnakeProfileLoad);
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    // The temporary file only outlives a write that didn't get to the rename,
+    // if it is intact it is the newest save
+    bool loaded = snake_saver_read(storage, SAVING_TMP_FILENAME, snake_state) ||
+                  snake_saver_read(storage, SAVING_FILENAME, snake_state);
+    furi_record_close(RECORD_STORAGE);
+    SNAKE_PROFILE_END(SnakeProfileLoad);
+    return loaded;
+}
+
+size_t snake_saver_load_replay(uint8_t* buffer, size_t size) {
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    File* file = storage_file_alloc(storage);
+    size_t read = 0;
+    // Replays are best effort, the temporary file is only a fallback here
+    bool opened = storage_file_open(file, REPLAY_FILENAME, FSAM_READ, FSOM_OPEN_EXISTING);
+    if(!opened) {
+        storage_file_close(file);
+        opened = storage_file_open(file, REPLAY_TMP_FILENAME, FSAM_READ, FSOM_OPEN_EXISTING);
+    }
+    if(opened) {
+        read = storage_file_read(file, buffer, size);
+    }
+    storage_file_close(file);
+    storage_file_free(file);
+    furi_record_close(RECORD_STORAGE);
+    return read;
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+// Saving on a background thread, so SD card latency never stalls the game loop.
+//
+// A request encodes the state right away (a few microseconds) and leaves the write
+// to the worker. Requests that pile up while it is busy collapse into one write
+// of the newest snapshot. Files are written next to the save and renamed over it,
+// so a power cut leaves either the old save or the new one, never half of one.
+
+#include "snake_game.h"
+
+typedef struct SnakeSaver SnakeSaver;
+
+SnakeSaver* snake_saver_alloc(void);
+
+// Writes what is still pending, then stops the worker
+void snake_saver_free(SnakeSaver* saver);
+
+void snake_saver_request(SnakeSaver* saver, SnakeState const* const snake_state);
+
+// Hands a finished replay file (see snake_journal.h) to the worker, `data` is copied
+void snake_saver_request_replay(SnakeSaver* saver, const uint8_t* data, size_t size);
+
+#ifdef SNAKE_PROFILE
+// Hands the text of a profile report (see snake_profile.h) to the worker, `text` is copied
+void snake_saver_request_profile(SnakeSaver* saver, const char* text, size_t size);
+#endif
+
+// Synchronous, meant for startup. Picks up the temporary file if a write was
+// interrupted before its rename.
+bool snake_saver_load(SnakeState* const snake_state);
+
+// Reads the last replay file into `buffer`, returns its size or 0
+size_t snake_saver_load_replay(uint8_t* buffer, size_t size);
@@ -0,0 +1,90 @@
+#include "snake_scheduler.h"
+
+#include <string.h>
+
+void snake_scheduler_init(SnakeScheduler* const scheduler, uint32_t ticks_per_second) {
+    memset(scheduler, 0, sizeof(SnakeScheduler));
+    scheduler->ticks_per_second = ticks_per_second;
+    scheduler->speed = SnakeSpeedNormal;
+}
+
+void snake_scheduler_reset(SnakeScheduler* const scheduler, uint32_t now) {
+    scheduler->last_tick = now;
+    scheduler->accumulated = 0;
+    scheduler->measure = false;
+}
+
+void snake_scheduler_new_game(SnakeScheduler* const scheduler, uint32_t now) {
+    snake_scheduler_reset(scheduler, now);
+    memset(scheduler->speed_ticks, 0, sizeof(scheduler->speed_ticks));
+}
+
+void snake_scheduler_set_speed(SnakeScheduler* const scheduler, SnakeSpeed speed) {
+    if(scheduler->speed != speed) {
+        // The time already waited counts towards the new interval
+        scheduler->speed = speed;
+        scheduler->measure = false;
+    }
+}
+
+uint32_t snake_scheduler_interval_ms(SnakeScheduler const* const scheduler, uint16_t len) {
+    switch(scheduler->speed) {
+    case SnakeSpeedBoost:
+        return SNAKE_SCHEDULER_BOOST_MS;
+    case SnakeSpeedBrake:
+        return SNAKE_SCHEDULER_BRAKE_MS;
+    case SnakeSpeedNormal:
+    case SnakeSpeedCount:
+        break;
+    }
+
+    // The arena's snakes start shorter than 7
+    uint32_t speedup = len > 7 ? (len - 7U) / 16 * SNAKE_SCHEDULER_CURVE_MS : 0;
+    if(speedup > SNAKE_SCHEDULER_NORMAL_MS - SNAKE_SCHEDULER_BOOST_MS) {
+        speedup = SNAKE_SCHEDULER_NORMAL_MS - SNAKE_SCHEDULER_BOOST_MS;
+    }
+    return SNAKE_SCHEDULER_NORMAL_MS - speedup;
+}
+
+bool snake_scheduler_tick(
+    SnakeScheduler* const scheduler,
+    GameState state,
+    uint16_t len,
+    uint32_t now) {
+    uint32_t elapsed = now - scheduler->last_tick;
+    scheduler->accumulated += elapsed;
+    scheduler->last_tick = now;
+    if(state == GameStateLife || state == GameStateLastChance) {
+        scheduler->speed_ticks[scheduler->speed] += elapsed;
+    }
+
+    int32_t interval =
+        snake_scheduler_interval_ms(scheduler, len) * scheduler->ticks_per_second / 1000;
+    // Half a base period of slack: a tick that comes a little early still takes the step
+    // instead of pushing it a whole period later
+    int32_t slack = SNAKE_SCHEDULER_BASE_MS * scheduler->ticks_per_second / 2000;
+    if(scheduler->accumulated + slack < interval) {
+        return false;
+    }
+
+    // Keep the remainder, an early step is paid back by the next one so the average rate
+    // is exact, but never owe more than one step: after a stall the game resumes, it
+    // doesn't fast-forward
+    scheduler->accumulated -= interval;
+    if(scheduler->accumulated > interval) {
+        scheduler->accumulated = interval;
+    }
+
+    if(scheduler->measure) {
+        int32_t real = now - scheduler->last_step;
+        uint32_t jitter = real > interval ? real - interval : interval - real;
+        if(jitter > scheduler->jitter_max) {
+            scheduler->jitter_max = jitter;
+        }
+        scheduler->jitter_sum += jitter;
+        scheduler->steps_measured++;
+    }
+    scheduler->last_step = now;
+    scheduler->measure = true;
+    return true;
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+// When the snake moves.
+//
+// The app runs one timer at a fixed base rate and asks the scheduler on every tick
+// whether a step is due. Elapsed time is accumulated from the clock, not counted in
+// ticks, so a late tick doesn't shift the following steps, and changing the speed
+// never restarts the phase: steps stay within one base period of their nominal time.
+
+#include "snake_game.h"
+
+#define SNAKE_SCHEDULER_BASE_MS 25 // every step interval is a multiple of this
+
+// Nominal step intervals
+#define SNAKE_SCHEDULER_NORMAL_MS 250
+#define SNAKE_SCHEDULER_BOOST_MS 125
+#define SNAKE_SCHEDULER_BRAKE_MS 500
+
+// Speed curve: the normal interval shrinks by this much for every 16 fruits eaten,
+// down to the boost interval. 0 keeps the classic constant speed.
+#ifndef SNAKE_SCHEDULER_CURVE_MS
+#define SNAKE_SCHEDULER_CURVE_MS 0
+#endif
+
+typedef enum {
+    SnakeSpeedNormal,
+    SnakeSpeedBoost, // holding the direction the snake moves in
+    SnakeSpeedBrake, // holding the opposite one
+    SnakeSpeedCount,
+} SnakeSpeed;
+
+typedef struct {
+    uint32_t ticks_per_second; // of the clock passed to snake_scheduler_tick
+    SnakeSpeed speed;
+    uint32_t last_tick; // clock at the previous call
+    int32_t accumulated; // clock ticks since the last step was due
+    // Step spacing, the real interval against the nominal one
+    uint32_t last_step;
+    bool measure; // false for the first step after a reset or a speed change
+    uint32_t steps_measured;
+    uint32_t jitter_max; // clock ticks
+    uint64_t jitter_sum;
+    // Time the game ran at each speed since snake_scheduler_new_game, clock ticks
+    uint32_t speed_ticks[SnakeSpeedCount];
+} SnakeScheduler;
+
+void snake_scheduler_init(SnakeScheduler* const scheduler, uint32_t ticks_per_second);
+
+// Starts counting from `now`, when the game (re)starts or resumes from pause
+void snake_scheduler_reset(SnakeScheduler* const scheduler, uint32_t now);
+
+// Like snake_scheduler_reset, and clears the time spent at each speed
+void snake_scheduler_new_game(SnakeScheduler* const scheduler, uint32_t now);
+
+void snake_scheduler_set_speed(SnakeScheduler* const scheduler, SnakeSpeed speed);
+
+// Nominal step interval in milliseconds for the current speed and snake length
+uint32_t snake_scheduler_interval_ms(SnakeScheduler const* const scheduler, uint16_t len);
+
+// Call on every base tick with the state and length of the player's snake, the classic
+// game's or the arena's. Returns true if the game should take a step.
+bool snake_scheduler_tick(
+    SnakeScheduler* const scheduler,
+    GameState state,
+    uint16_t len,
+    uint32_t now);